@@ -314,11 +314,13 @@ QMAKE_SUBSTITUTES += IaitoConfig.h.in
 SOURCES += \
     Main.cpp \
     core/Iaito.cpp \
+    core/NativeDescriptions.cpp \
     dialogs/EditStringDialog.cpp \
     dialogs/WriteCommandsDialogs.cpp \
     widgets/DisassemblerGraphView.cpp \
     widgets/OverviewView.cpp \
     common/RichTextPainter.cpp \
+    common/RichTextAnsi.cpp \
     dialogs/InitialOptionsDialog.cpp \
     dialogs/AboutDialog.cpp \
     dialogs/CommentsDialog.cpp \
@@ -335,6 +337,8 @@ SOURCES += \
     dialogs/preferences/AsmOptionsWidget.cpp \
     dialogs/NewFileDialog.cpp \
     common/AnalTask.cpp \
+    common/AnalysisCache.cpp \
+    common/AnalysisSnapshot.cpp \
     widgets/CommentsWidget.cpp \
     widgets/ConsoleWidget.cpp \
     widgets/Dashboard.cpp \
@@ -394,6 +398,8 @@ SOURCES += \
     widgets/BacktraceWidget.cpp \
     dialogs/MapFileDialog.cpp \
     common/CommandTask.cpp \
+    common/HashTask.cpp \
+    common/GraphLayoutTask.cpp \
     common/ProgressIndicator.cpp \
     common/R2Task.cpp \
     dialogs/R2TaskDialog.cpp \
@@ -436,6 +442,7 @@ SOURCES += \
     common/HighDpiPixmap.cpp \
     widgets/GraphGridLayout.cpp \
     widgets/HexWidget.cpp \
+    widgets/HexGlyphAtlas.cpp \
     common/SelectionHighlight.cpp \
     common/Decompiler.cpp \
     common/R2GhidraCmdDecompiler.cpp \
@@ -451,6 +458,7 @@ SOURCES += \
     dialogs/LayoutManager.cpp \
     common/IaitoLayout.cpp \
     widgets/GraphHorizontalAdapter.cpp \
+    widgets/GraphSpatialIndex.cpp \
     common/ResourcePaths.cpp \
     widgets/IaitoGraphView.cpp \
     widgets/SimpleTextGraphView.cpp \
@@ -458,7 +466,11 @@ SOURCES += \
     widgets/CallGraph.cpp \
     widgets/AddressableDockWidget.cpp \
     dialogs/preferences/AnalOptionsWidget.cpp \
-    common/DecompilerHighlighter.cpp
+    common/DecompilerHighlighter.cpp \
+    common/JsonStream.cpp \
+    common/CommandProfiler.cpp \
+    common/InstructionIndex.cpp \
+    widgets/CommandProfilerWidget.cpp
 
 GRAPHVIZ_SOURCES = \
     widgets/GraphvizLayout.cpp
@@ -467,6 +479,7 @@ HEADERS  += \
     core/Iaito.h \
     core/IaitoCommon.h \
     core/IaitoDescriptions.h \
+    core/NativeDescriptions.h \
     dialogs/EditStringDialog.h \
     dialogs/WriteCommandsDialogs.h \
     widgets/DisassemblerGraphView.h \
@@ -489,6 +502,8 @@ HEADERS  += \
     dialogs/InitialOptionsDialog.h \
     dialogs/NewFileDialog.h \
     common/AnalTask.h \
+    common/AnalysisCache.h \
+    common/AnalysisSnapshot.h \
     widgets/CommentsWidget.h \
     widgets/ConsoleWidget.h \
     widgets/Dashboard.h \
@@ -550,6 +565,8 @@ HEADERS  += \
     common/StringsTask.h \
     common/FunctionsTask.h \
     common/CommandTask.h \
+    common/HashTask.h \
+    common/GraphLayoutTask.h \
     common/ProgressIndicator.h \
     plugins/IaitoPlugin.h \
     common/R2Task.h \
@@ -596,6 +613,7 @@ HEADERS  += \
     widgets/GraphLayout.h \
     widgets/GraphGridLayout.h \
     widgets/HexWidget.h \
+    widgets/HexGlyphAtlas.h \
     common/SelectionHighlight.h \
     common/Decompiler.h \
     common/R2GhidraCmdDecompiler.h \
@@ -614,6 +632,7 @@ HEADERS  += \
     common/BinaryTrees.h \
     common/LinkedListPool.h \
     widgets/GraphHorizontalAdapter.h \
+    widgets/GraphSpatialIndex.h \
     common/ResourcePaths.h \
     widgets/IaitoGraphView.h \
     widgets/SimpleTextGraphView.h \
@@ -621,7 +640,11 @@ HEADERS  += \
     widgets/CallGraph.h \
     widgets/AddressableDockWidget.h \
     dialogs/preferences/AnalOptionsWidget.h \
-    common/DecompilerHighlighter.h
+    common/DecompilerHighlighter.h \
+    common/JsonStream.h \
+    common/CommandProfiler.h \
+    common/InstructionIndex.h \
+    widgets/CommandProfilerWidget.h
 
 GRAPHVIZ_HEADERS = widgets/GraphvizLayout.h
 
@@ -1,5 +1,6 @@
 #include "core/Iaito.h"
 #include "common/AnalTask.h"
+#include "common/AnalysisCache.h"
 #include "core/MainWindow.h"
 #include "dialogs/InitialOptionsDialog.h"
 #include <QJsonArray>
@@ -21,6 +22,15 @@ void AnalTask::interrupt()
     r_cons_singleton()->context->breaked = true;
 }
 
+QList<CommandDescription> AnalTask::getRemainingPasses()
+{
+    // Until a pass completes there is no checkpoint, e.g. when the only pass is "aaa"
+    if (completedPasses == 0) {
+        return {};
+    }
+    return options.analCmd.mid(completedPasses);
+}
+
 QString AnalTask::getTitle() {
     // If no file is loaded we consider it's Initial Analysis
     QJsonArray openedFiles = Core()->getOpenedFiles();
@@ -32,6 +42,9 @@ QString AnalTask::getTitle() {
 
 void AnalTask::runTask()
 {
+    loaded = false;
+    completedPasses = 0;
+
     int perms = R_PERM_RX;
     if (options.writeEnabled) {
         perms |= R_PERM_W;
@@ -44,8 +57,19 @@ void AnalTask::runTask()
 
     // Do not reload the file if already loaded
     QJsonArray openedFiles = Core()->getOpenedFiles();
-    if (!openedFiles.size() && options.filename.length()) {
-        log(tr("Loading the file..."));
+    const bool loadFile = !openedFiles.size() && options.filename.length();
+
+    // Every step counts the same, r2 does not report progress from within a command
+    const int totalSteps = (loadFile ? 1 : 0) + (options.pdbFile.isNull() ? 0 : 1)
+                           + (options.script.isNull() ? 0 : 1) + static_cast<int>(options.analCmd.size());
+    int step = 0;
+    auto beginStep = [this, &step, totalSteps](const QString &phase) {
+        log(phase);
+        setProgress(step++ * 100 / qMax(1, totalSteps), phase);
+    };
+
+    if (loadFile) {
+        beginStep(tr("Loading the file..."));
         openFailed = false;
         bool fileLoaded = Core()->loadFile(options.filename,
                                            options.binLoadAddr,
@@ -75,7 +99,7 @@ void AnalTask::runTask()
     }
 
     if (!options.pdbFile.isNull()) {
-        log(tr("Loading PDB file..."));
+        beginStep(tr("Loading PDB file..."));
         Core()->loadPDB(options.pdbFile);
     }
 
@@ -95,7 +119,7 @@ void AnalTask::runTask()
     Core()->cmdRaw("fs *");
 
     if (!options.script.isNull()) {
-        log(tr("Executing script..."));
+        beginStep(tr("Executing script..."));
         Core()->loadScript(options.script);
     }
 
@@ -103,18 +127,51 @@ void AnalTask::runTask()
         return;
     }
 
+    // The file can be used from here on, passes only hold the core while they run
+    loaded = true;
+    emit fileLoaded();
+
+    // Reuse the results of an earlier analysis of the same file
+    QString cacheKey;
+    if (loadFile && options.useAnalysisCache && !options.analCmd.empty()) {
+        log(tr("Looking for a cached analysis..."));
+        cacheKey = AnalysisCache::key(options, this);
+        if (isInterrupted()) {
+            return;
+        }
+        if (!cacheKey.isEmpty() && AnalysisCache::load(cacheKey)) {
+            completedPasses = options.analCmd.size();
+            log(tr("Loaded the analysis from the cache."));
+            setProgress(100, tr("Done"));
+            return;
+        }
+    }
+
     if (!options.analCmd.empty()) {
         log(tr("Executing analysis..."));
         for (const CommandDescription &cmd : options.analCmd) {
             if (isInterrupted()) {
                 return;
             }
-            log(cmd.description);
-            // use cmd instead of cmdRaw because commands can be unexpected
-            Core()->cmd(cmd.command);
+            beginStep(cmd.description);
+            // Not cmdRaw because commands can be unexpected, and as an r2 task
+            // so that interrupt() breaks it even if it resets the global break flag
+            Core()->cmdTask(cmd.command, this);
+            if (isInterrupted()) {
+                return;
+            }
+            completedPasses++;
+            // Publish what the pass found, widgets refresh between passes
+            emit Core()->functionsChanged();
+            emit Core()->flagsChanged();
         }
         log(tr("Analysis complete!"));
+        if (!cacheKey.isEmpty()) {
+            log(tr("Storing the analysis in the cache..."));
+            AnalysisCache::store(cacheKey);
+        }
     } else {
         log(tr("Skipping Analysis."));
     }
+    setProgress(100, tr("Done"));
 }
@@ -18,23 +18,42 @@ public:
     ~AnalTask();
 
     QString getTitle() override;
+    Priority getPriority() override { return Priority::Background; }
 
     void setOptions(const InitialOptions &options)	{ this->options = options; }
 
     void interrupt() override;
 
     bool getOpenFileFailed()	{ return openFailed; }
+    /**
+     * @brief Whether fileLoaded() was emitted
+     */
+    bool getFileLoaded()	{ return loaded; }
+    /**
+     * @brief Analysis passes that did not complete, the first one may have been interrupted.
+     * Running them in a new AnalTask resumes the analysis, r2 keeps what earlier passes found.
+     * Empty if every pass completed, or none did since resuming would then be starting over.
+     */
+    QList<CommandDescription> getRemainingPasses();
 
 protected:
     void runTask() override;
 
 signals:
     void openFileFailed();
+    /**
+     * @brief The file with its sections, symbols and entrypoints is ready,
+     * the analysis passes are about to start
+     */
+    void fileLoaded();
 
 private:
     InitialOptions options;
 
     bool openFailed = false;
+    std::atomic<bool> loaded { false };
+    /** Number of passes at the start of options.analCmd that completed */
+    std::atomic<int> completedPasses { 0 };
 };
 
 #endif // ANALTHREAD_H
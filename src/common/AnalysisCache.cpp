@@ -0,0 +1,158 @@
+#include "AnalysisCache.h"
+#include "common/AnalysisSnapshot.h"
+#include "common/AsyncTask.h"
+#include "common/Configuration.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// Bump whenever the snapshot contents or their loading change
+static const int CACHE_FORMAT_VERSION = 2;
+static const int HASH_CHUNK_SIZE = 4 * 1024 * 1024;
+
+static QByteArray cacheHeader()
+{
+    return QStringLiteral("# iaito analysis cache %1 r2 %2\n")
+           .arg(CACHE_FORMAT_VERSION).arg(QString::fromUtf8(r_core_version())).toUtf8();
+}
+
+static QString cachePath(const QString &key)
+{
+    return AnalysisCache::directory().filePath(key + ".sdb");
+}
+
+QDir AnalysisCache::directory()
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation));
+    dir.mkpath("analysis-cache");
+    dir.cd("analysis-cache");
+    return dir;
+}
+
+QString AnalysisCache::key(const InitialOptions &options, AsyncTask *task)
+{
+    // Scripts and shellcode may change anything, their results are not reproducible from the key
+    if (options.filename.isEmpty() || !options.script.isEmpty() || !options.shellcode.isEmpty()) {
+        return QString();
+    }
+
+    QFile file(options.filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    while (!file.atEnd()) {
+        if (task && task->isInterrupted()) {
+            return QString();
+        }
+        const QByteArray chunk = file.read(HASH_CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            return QString();
+        }
+        hash.addData(chunk);
+    }
+    const QByteArray fileHash = hash.result().toHex();
+
+    QStringList optionValues;
+    optionValues << options.arch << options.cpu << QString::number(options.bits) << options.os
+                 << QString::number(static_cast<int>(options.endian))
+                 << QString::number(options.binLoadAddr) << QString::number(options.mapAddr)
+                 << QString::number(options.useVA) << QString::number(options.loadBinInfo)
+                 << options.forceBinPlugin << QString::number(options.demangle)
+                 << options.pdbFile;
+    for (const CommandDescription &cmd : options.analCmd) {
+        optionValues << cmd.command;
+    }
+    // Analysis preferences and iaitorc change what the passes find too
+    optionValues << Core()->cmdRaw("e anal.");
+    const QByteArray optionsHash = QCryptographicHash::hash(optionValues.join('\n').toUtf8(),
+                                                            QCryptographicHash::Sha256).toHex();
+
+    return QString::fromLatin1(fileHash + "-" + optionsHash.left(16));
+}
+
+bool AnalysisCache::load(const QString &key)
+{
+    const QString path = cachePath(key);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (file.readLine() != cacheHeader()) {
+        // Written by another version, its snapshot may not load the same anymore
+        file.close();
+        QFile::remove(path);
+        return false;
+    }
+    const QByteArray snapshot = file.readAll();
+    file.close();
+
+    bool loaded;
+    {
+        RCoreLocked core = Core()->core();
+        loaded = AnalysisSnapshot::read(core, snapshot);
+    }
+    Core()->bumpAnalysisGeneration();
+    Core()->triggerRefreshAll();
+    if (!loaded) {
+        // Whatever was read is kept, the analysis passes run over it
+        QFile::remove(path);
+        return false;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    // Keep recently used entries from being evicted
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+#endif
+    return true;
+}
+
+bool AnalysisCache::store(const QString &key)
+{
+    QSaveFile file(cachePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(cacheHeader());
+    bool written;
+    {
+        RCoreLocked core = Core()->coreShared();
+        written = AnalysisSnapshot::write(core, file);
+    }
+
+    // Eviction would remove it right away, along with everything else
+    const qint64 maxSize = Config()->getAnalysisCacheMaxSize();
+    if (!written || file.size() > maxSize) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        return false;
+    }
+
+    evict(maxSize);
+    return true;
+}
+
+void AnalysisCache::evict(qint64 maxSize)
+{
+    // Left over from the r2 script entries of format 1
+    for (const QFileInfo &entry : directory().entryInfoList({ "*.r2" }, QDir::Files)) {
+        QFile::remove(entry.absoluteFilePath());
+    }
+
+    // Most recently used first
+    const QFileInfoList entries = directory().entryInfoList({ "*.sdb" }, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        total += entry.size();
+        if (total > maxSize) {
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+
+#include "common/InitialOptions.h"
+
+#include <QDir>
+
+class AsyncTask;
+
+/**
+ * @brief Analysis results of previously opened files, kept as AnalysisSnapshot files in the
+ * config directory so that opening an identical file again can skip the analysis passes.
+ *
+ * Entries are keyed by the SHA-256 of the file together with every option that changes
+ * what the analysis finds. Once they take more than Configuration::getAnalysisCacheMaxSize()
+ * the least recently used ones are removed.
+ */
+class AnalysisCache
+{
+public:
+    /**
+     * @param task if set, hashing stops once it is interrupted
+     * @return key of the results for opening options.filename with options,
+     *         empty if they can not be cached
+     */
+    static QString key(const InitialOptions &options, AsyncTask *task = nullptr);
+
+    /**
+     * @brief Load the entry stored under key into the core
+     * @return false if there is no entry written by this version of iaito and r2
+     */
+    static bool load(const QString &key);
+
+    /**
+     * @brief Store the current analysis under key, then evict entries beyond the size limit
+     */
+    static bool store(const QString &key);
+
+    /**
+     * @brief Remove the least recently used entries until the rest fit in maxSize bytes
+     */
+    static void evict(qint64 maxSize);
+
+    static QDir directory();
+};
+
+#endif // ANALYSISCACHE_H
@@ -0,0 +1,31 @@
+#include "AnalysisSnapshot.h"
+
+#include <QFileDevice>
+
+namespace AnalysisSnapshot {
+
+bool write(RCore *core, QFileDevice &file)
+{
+    Sdb *db = sdb_new0();
+    r_serialize_flag_save(sdb_ns(db, "flags", true), core->flags);
+    r_serialize_anal_save(sdb_ns(db, "anal", true), core->anal);
+    // sdb writes to the descriptor, after what the device still buffers
+    const bool ok = file.flush() && sdb_text_save_fd(db, file.handle(), true);
+    sdb_free(db);
+    return ok;
+}
+
+bool read(RCore *core, QByteArray data)
+{
+    Sdb *db = sdb_new0();
+    // Parsed in place, data is a copy
+    bool ok = sdb_text_load_buf(db, data.data(), static_cast<size_t>(data.size()));
+    Sdb *flags = ok ? sdb_ns(db, "flags", false) : nullptr;
+    Sdb *anal = ok ? sdb_ns(db, "anal", false) : nullptr;
+    ok = flags && anal && r_serialize_flag_load(flags, core->flags, nullptr)
+         && r_serialize_anal_load(anal, core->anal, nullptr);
+    sdb_free(db);
+    return ok;
+}
+
+}
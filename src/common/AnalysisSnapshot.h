@@ -0,0 +1,33 @@
+#ifndef ANALYSISSNAPSHOT_H
+#define ANALYSISSNAPSHOT_H
+
+#include "core/IaitoCommon.h"
+
+#include <QByteArray>
+
+class QFileDevice;
+
+/**
+ * @brief Flags and the whole RAnal state of a core, in the r_serialize sdb format of r2
+ * projects.
+ *
+ * Besides functions, xrefs, metadata and hints this covers function variables, types,
+ * calling conventions, noreturn functions, classes and signatures. The caller holds the
+ * core lock. tests/AnalysisSnapshotTest.cpp checks that a round trip keeps them.
+ */
+namespace AnalysisSnapshot {
+
+/**
+ * @brief Append the snapshot of \a core to the open \a file
+ */
+IAITO_EXPORT bool write(RCore *core, QFileDevice &file);
+
+/**
+ * @brief Replace the flags and the analysis of \a core with a snapshot
+ * @param data what write() wrote
+ */
+IAITO_EXPORT bool read(RCore *core, QByteArray data);
+
+}
+
+#endif // ANALYSISSNAPSHOT_H
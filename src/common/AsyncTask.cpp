@@ -1,5 +1,8 @@
 
 #include "AsyncTask.h"
+#include "common/CommandProfiler.h"
+
+#include <QThread>
 
 AsyncTask::AsyncTask()
     : QObject(nullptr),
@@ -38,18 +41,33 @@ void AsyncTask::prepareRun()
 {
     interrupted = false;
     wait();
+    progress = -1;
+    {
+        QMutexLocker locker(&phaseMutex);
+        phase.clear();
+    }
     timer.start();
 }
 
+void AsyncTask::cancelPending()
+{
+    interrupted = true;
+    emit finished();
+}
+
 void AsyncTask::run()
 {
     runningMutex.lock();
 
     running = true;
+    runStartedMs = timer.elapsed();
 
     logBuffer.clear();
     emit logChanged(logBuffer);
-    runTask();
+    {
+        CommandProfiler::Context profilerContext(getTitle());
+        runTask();
+    }
 
     running = false;
 
@@ -64,10 +82,48 @@ void AsyncTask::log(QString s)
     emit logChanged(logBuffer);
 }
 
+void AsyncTask::setProgress(int percent, const QString &phase)
+{
+    if (!phase.isNull()) {
+        QMutexLocker locker(&phaseMutex);
+        this->phase = phase;
+    }
+    progress = qBound(-1, percent, 100);
+    emit progressChanged(progress);
+}
+
+QString AsyncTask::getPhase()
+{
+    QMutexLocker locker(&phaseMutex);
+    return phase;
+}
+
+qint64 AsyncTask::getRemainingTime()
+{
+    const int done = progress;
+    if (done <= 0 || !running) {
+        return -1;
+    }
+    const qint64 elapsed = getElapsedTime() - runStartedMs;
+    return elapsed * (100 - done) / done;
+}
+
 AsyncTaskManager::AsyncTaskManager(QObject *parent)
     : QObject(parent)
 {
+    const int cores = qMax(1, QThread::idealThreadCount());
+    queues[static_cast<int>(AsyncTask::Priority::Interactive)].limit = qMax(2, cores);
+    queues[static_cast<int>(AsyncTask::Priority::Refresh)].limit = qMax(1, cores / 2);
+    queues[static_cast<int>(AsyncTask::Priority::Background)].limit = 1;
+
+    int threads = 0;
+    for (const ClassQueue &queue : queues) {
+        threads += queue.limit;
+    }
     threadPool = new QThreadPool(this);
+    // Every class can use its whole limit at the same time, so none waits for a thread of another
+    threadPool->setMaxThreadCount(threads);
+    threadPool->setStackSize(R2THREAD_STACK_SIZE);
 }
 
 AsyncTaskManager::~AsyncTaskManager()
@@ -76,20 +132,129 @@ AsyncTaskManager::~AsyncTaskManager()
 
 void AsyncTaskManager::start(AsyncTask::Ptr task)
 {
-    tasks.append(task);
     task->prepareRun();
 
+    QList<AsyncTask::Ptr> dropped;
+    const QString key = task->getCoalescingKey();
+    if (!key.isEmpty()) {
+        for (ClassQueue &queue : queues) {
+            for (auto it = queue.pending.begin(); it != queue.pending.end();) {
+                if ((*it)->getCoalescingKey() == key) {
+                    dropped.append(*it);
+                    it = queue.pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (const AsyncTask::Ptr &other : running) {
+            if (other->getCoalescingKey() == key && !other->isInterrupted()) {
+                other->interrupt();
+                supersededCount++;
+            }
+        }
+    }
+
     QWeakPointer<AsyncTask> weakPtr = task;
     connect(task.data(), &AsyncTask::finished, this, [this, weakPtr]() {
-        tasks.removeOne(weakPtr);
-        emit tasksChanged();
+        taskFinished(weakPtr.toStrongRef());
     });
-    threadPool->setStackSize(R2THREAD_STACK_SIZE);
-    threadPool->start(task.data());
+    queues[static_cast<int>(task->getPriority())].pending.append(task);
+
+    coalescedCount += dropped.size();
+    for (const AsyncTask::Ptr &other : dropped) {
+        other->cancelPending();
+    }
+
+    schedule();
+    emit tasksChanged();
+}
+
+void AsyncTaskManager::schedule()
+{
+    QList<AsyncTask::Ptr> dropped;
+    for (ClassQueue &queue : queues) {
+        // Interrupted before they got a thread, e.g. a graph layout cancelled by a newer one
+        for (auto it = queue.pending.begin(); it != queue.pending.end();) {
+            if ((*it)->isInterrupted()) {
+                dropped.append(*it);
+                it = queue.pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto it = queue.pending.begin();
+                it != queue.pending.end() && queue.running < queue.limit;) {
+            AsyncTask::Ptr task = *it;
+            // Wait for the task this one supersedes, so that results arrive in order
+            if (!task->getCoalescingKey().isEmpty() && isKeyRunning(task->getCoalescingKey())) {
+                ++it;
+                continue;
+            }
+            it = queue.pending.erase(it);
+            queue.running++;
+            running.append(task);
+            dispatchedCount++;
+            totalWaitMs += task->getElapsedTime();
+            threadPool->start(task.data());
+        }
+    }
+
+    // Only after the loops, finished() may start or schedule other tasks
+    for (const AsyncTask::Ptr &task : dropped) {
+        task->cancelPending();
+    }
+}
+
+bool AsyncTaskManager::isKeyRunning(const QString &key)
+{
+    for (const AsyncTask::Ptr &task : running) {
+        if (task->getCoalescingKey() == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AsyncTaskManager::taskFinished(AsyncTask::Ptr task)
+{
+    if (task && running.removeOne(task)) {
+        queues[static_cast<int>(task->getPriority())].running--;
+        finishedCount++;
+        schedule();
+    }
     emit tasksChanged();
 }
 
 bool AsyncTaskManager::getTasksRunning()
 {
-    return !tasks.isEmpty();
+    if (!running.isEmpty()) {
+        return true;
+    }
+    for (const ClassQueue &queue : queues) {
+        if (!queue.pending.isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AsyncTaskManager::QueueStats AsyncTaskManager::getQueueStats()
+{
+    QueueStats stats;
+    stats.oldestPendingMs = 0;
+    for (int i = 0; i < AsyncTask::PriorityCount; i++) {
+        const ClassQueue &queue = queues[i];
+        stats.pending[i] = queue.pending.size();
+        stats.running[i] = queue.running;
+        stats.limit[i] = queue.limit;
+        for (const AsyncTask::Ptr &task : queue.pending) {
+            stats.oldestPendingMs = qMax(stats.oldestPendingMs, task->getElapsedTime());
+        }
+    }
+    stats.coalesced = coalescedCount;
+    stats.superseded = supersededCount;
+    stats.finished = finishedCount;
+    stats.averageWaitMs = dispatchedCount ? totalWaitMs / static_cast<qint64>(dispatchedCount) : 0;
+    return stats;
 }
@@ -11,6 +11,8 @@
 #include <QSharedPointer>
 #include <QList>
 
+#include <atomic>
+
 class AsyncTaskManager;
 
 // 8 MB should be enough for deep analysis.. default is 512KB
@@ -25,6 +27,19 @@ class IAITO_EXPORT  AsyncTask : public QObject, public QRunnable
 public:
     using Ptr = QSharedPointer<AsyncTask>;
 
+    /**
+     * @brief Scheduling class, pending tasks of a higher class always start first
+     */
+    enum class Priority {
+        /** Directly requested by the user, who is waiting for the result */
+        Interactive,
+        /** Fetches data for a visible widget */
+        Refresh,
+        /** Long running work that nothing else should queue behind */
+        Background
+    };
+    static const int PriorityCount = 3;
+
     AsyncTask();
     ~AsyncTask();
 
@@ -41,41 +56,114 @@ public:
     qint64 getElapsedTime()             { return timer.isValid() ? timer.elapsed() : 0; }
 
     virtual QString getTitle()          { return QString(); }
+    virtual Priority getPriority()      { return Priority::Refresh; }
+
+    /**
+     * @brief Percentage done, -1 if the task does not report progress
+     */
+    int getProgress()                   { return progress; }
+    /**
+     * @brief Description of what the task is doing right now
+     */
+    QString getPhase();
+    /**
+     * @brief Estimated milliseconds left based on the progress so far, -1 if unknown
+     */
+    qint64 getRemainingTime();
+
+    /**
+     * @brief Tasks with the same non-empty key replace each other, see AsyncTaskManager::start()
+     */
+    void setCoalescingKey(const QString &key)   { coalescingKey = key; }
+    const QString &getCoalescingKey()           { return coalescingKey; }
 
 protected:
     virtual void runTask() =0;
 
     void log(QString s);
+    /**
+     * @param phase replaces the current phase unless null
+     */
+    void setProgress(int percent, const QString &phase = QString());
 
 signals:
     void finished();
     void logChanged(const QString &log);
+    void progressChanged(int percent);
 
 private:
     bool running;
-    bool interrupted;
+    std::atomic<bool> interrupted { false };
     QMutex runningMutex;
 
     QElapsedTimer timer;
     QString logBuffer;
+    QString coalescingKey;
+
+    std::atomic<int> progress { -1 };
+    std::atomic<qint64> runStartedMs { 0 };
+    QMutex phaseMutex;
+    QString phase;
 
     void prepareRun();
+    /**
+     * @brief Finish a task that never started
+     */
+    void cancelPending();
 };
 
 class AsyncTaskManager : public QObject
 {
     Q_OBJECT
 
+public:
+    struct QueueStats {
+        int pending[AsyncTask::PriorityCount];
+        int running[AsyncTask::PriorityCount];
+        int limit[AsyncTask::PriorityCount];
+        /** Pending tasks replaced by a newer one with the same coalescing key */
+        quint64 coalesced;
+        /** Running tasks interrupted because a newer one with the same coalescing key arrived */
+        quint64 superseded;
+        quint64 finished;
+        /** Average time between start() and the task getting a thread */
+        qint64 averageWaitMs;
+        qint64 oldestPendingMs;
+    };
+
 private:
+    struct ClassQueue {
+        QList<AsyncTask::Ptr> pending;
+        int running = 0;
+        int limit = 1;
+    };
+
     QThreadPool *threadPool;
-    QList<AsyncTask::Ptr> tasks;
+    ClassQueue queues[AsyncTask::PriorityCount];
+    QList<AsyncTask::Ptr> running;
+
+    quint64 coalescedCount = 0;
+    quint64 supersededCount = 0;
+    quint64 finishedCount = 0;
+    quint64 dispatchedCount = 0;
+    qint64 totalWaitMs = 0;
+
+    void schedule();
+    bool isKeyRunning(const QString &key);
+    void taskFinished(AsyncTask::Ptr task);
 
 public:
     explicit AsyncTaskManager(QObject *parent = nullptr);
     ~AsyncTaskManager();
 
+    /**
+     * @brief Queue a task in the class of its priority.
+     * If it has a coalescing key, pending tasks with the same key are dropped without running
+     * and running ones are interrupted. It will not start before those have finished.
+     */
     void start(AsyncTask::Ptr task);
     bool getTasksRunning();
+    QueueStats getQueueStats();
 
 signals:
     void tasksChanged();
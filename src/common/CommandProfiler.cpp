@@ -0,0 +1,222 @@
+#include "common/CommandProfiler.h"
+
+#include <QThread>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+static thread_local int scopeDepth = 0;
+static thread_local qint64 threadLockWaitNs = 0;
+static thread_local QString threadContext;
+
+CommandProfiler::CommandProfiler(QObject *parent)
+    : QObject(parent)
+{
+    clock.start();
+}
+
+CommandProfiler *CommandProfiler::instance()
+{
+    static CommandProfiler profiler;
+    return &profiler;
+}
+
+void CommandProfiler::setEnabled(bool enabled)
+{
+    if (this->enabled.exchange(enabled) != enabled) {
+        emit enabledChanged(enabled);
+    }
+}
+
+void CommandProfiler::addLockWait(qint64 waitNs)
+{
+    threadLockWaitNs += waitNs;
+}
+
+QString CommandProfiler::currentContext()
+{
+    return threadContext;
+}
+
+QString CommandProfiler::commandName(const QString &command)
+{
+    // Aggregate "pdJ 10 @ 0x1000" and "pdJ 20 @ 0x2000" together
+    QString name = command.trimmed();
+    int end = 0;
+    while (end < name.size() && !name[end].isSpace() && name[end] != QLatin1Char('@')) {
+        end++;
+    }
+    return end > 0 ? name.left(end) : name;
+}
+
+int CommandProfiler::threadIndex()
+{
+    const quintptr id = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    auto it = threadIndices.find(id);
+    if (it == threadIndices.end()) {
+        it = threadIndices.insert(id, threadIndices.size() + 1);
+    }
+    return it.value();
+}
+
+void CommandProfiler::record(Sample sample)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    sample.threadIndex = threadIndex();
+
+    const QString key = sample.context + QLatin1Char('\n') + sample.command;
+    Stats &s = stats[key];
+    if (s.count == 0) {
+        s.command = sample.command;
+        s.context = sample.context;
+        s.histogram.fill(0, HISTOGRAM_BUCKETS);
+    }
+    s.count++;
+    s.totalNs += sample.durationNs;
+    s.maxNs = std::max<quint64>(s.maxNs, sample.durationNs);
+    s.lockWaitNs += sample.lockWaitNs;
+    s.parseNs += sample.parseNs;
+    s.outputBytes += sample.outputSize;
+
+    int bucket = 0;
+    for (qint64 us = sample.durationNs / 1000; us > 1 && bucket < HISTOGRAM_BUCKETS - 1; us >>= 1) {
+        bucket++;
+    }
+    s.histogram[bucket]++;
+
+    if (samples.size() < MAX_TRACE_SAMPLES) {
+        samples.append(sample);
+    } else {
+        samples[nextSample] = sample;
+        nextSample = (nextSample + 1) % MAX_TRACE_SAMPLES;
+    }
+}
+
+void CommandProfiler::recordFinished(const QString &command, qint64 startNs, qint64 outputSize)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    Sample sample;
+    sample.command = commandName(command);
+    sample.context = currentContext();
+    sample.startNs = startNs;
+    sample.durationNs = now() - startNs;
+    sample.outputSize = outputSize;
+    record(sample);
+}
+
+QList<CommandProfiler::Stats> CommandProfiler::getStats() const
+{
+    QMutexLocker locker(&mutex);
+    return stats.values();
+}
+
+void CommandProfiler::reset()
+{
+    QMutexLocker locker(&mutex);
+    stats.clear();
+    samples.clear();
+    nextSample = 0;
+}
+
+QByteArray CommandProfiler::toChromeTrace() const
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonArray events;
+    for (int i = 0; i < samples.size(); i++) {
+        // Oldest first once the ring buffer wrapped around
+        const Sample &sample = samples[(nextSample + i) % samples.size()];
+        QJsonObject args;
+        if (!sample.context.isEmpty()) {
+            args["context"] = sample.context;
+        }
+        args["lockWaitUs"] = sample.lockWaitNs / 1000.0;
+        args["parseUs"] = sample.parseNs / 1000.0;
+        args["outputBytes"] = sample.outputSize;
+
+        QJsonObject event;
+        event["name"] = sample.command;
+        event["cat"] = QStringLiteral("r2");
+        event["ph"] = QStringLiteral("X");
+        event["ts"] = sample.startNs / 1000.0;
+        event["dur"] = sample.durationNs / 1000.0;
+        event["pid"] = 1;
+        event["tid"] = sample.threadIndex;
+        event["args"] = args;
+        events.append(event);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = QStringLiteral("ms");
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+CommandProfiler::Scope::Scope(const char *command)
+{
+    if (scopeDepth++ > 0 || !CommandProfiler::instance()->isEnabled()) {
+        return;
+    }
+    start(QString::fromUtf8(command));
+}
+
+CommandProfiler::Scope::Scope(const QString &command)
+{
+    if (scopeDepth++ > 0 || !CommandProfiler::instance()->isEnabled()) {
+        return;
+    }
+    start(command);
+}
+
+void CommandProfiler::Scope::start(const QString &command)
+{
+    active = true;
+    sample.command = commandName(command);
+    sample.context = threadContext;
+    sample.startNs = CommandProfiler::instance()->now();
+    lockWaitAtStart = threadLockWaitNs;
+}
+
+CommandProfiler::Scope::~Scope()
+{
+    scopeDepth--;
+    if (!active) {
+        return;
+    }
+    auto profiler = CommandProfiler::instance();
+    sample.durationNs = profiler->now() - sample.startNs;
+    sample.lockWaitNs = threadLockWaitNs - lockWaitAtStart;
+    profiler->record(sample);
+}
+
+void CommandProfiler::Scope::beginParse()
+{
+    if (active) {
+        parseTimer.start();
+    }
+}
+
+void CommandProfiler::Scope::endParse()
+{
+    if (active && parseTimer.isValid()) {
+        sample.parseNs += parseTimer.nsecsElapsed();
+    }
+}
+
+CommandProfiler::Context::Context(const QString &name)
+    : previous(threadContext)
+{
+    threadContext = name;
+}
+
+CommandProfiler::Context::~Context()
+{
+    threadContext = previous;
+}
@@ -0,0 +1,142 @@
+#ifndef COMMANDPROFILER_H
+#define COMMANDPROFILER_H
+
+#include "core/IaitoCommon.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <atomic>
+
+/**
+ * @brief Collects wall time, lock wait, JSON parse time and output size of the
+ * r2 commands executed by IaitoCore.
+ *
+ * Recording is disabled by default, in that state a Scope costs a single atomic load.
+ * Samples are aggregated per command name and context into log2 histograms and the
+ * most recent ones are kept for exporting a Chrome trace (chrome://tracing, Perfetto).
+ */
+class IAITO_EXPORT CommandProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Bucket i counts samples that took [2^i, 2^(i+1)) microseconds */
+    static const int HISTOGRAM_BUCKETS = 24;
+    static const int MAX_TRACE_SAMPLES = 100000;
+
+    struct Sample {
+        QString command;
+        QString context;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        qint64 lockWaitNs = 0;
+        qint64 parseNs = 0;
+        qint64 outputSize = 0;
+        int threadIndex = 0;
+    };
+
+    struct Stats {
+        QString command;
+        QString context;
+        quint64 count = 0;
+        quint64 totalNs = 0;
+        quint64 maxNs = 0;
+        quint64 lockWaitNs = 0;
+        quint64 parseNs = 0;
+        quint64 outputBytes = 0;
+        QVector<quint64> histogram;
+    };
+
+    /**
+     * @brief Measures one command, from construction to destruction. Nested scopes on the
+     * same thread (e.g. cmdRawAt calling cmdRaw) are folded into the outermost one.
+     */
+    class IAITO_EXPORT Scope
+    {
+    public:
+        explicit Scope(const char *command);
+        explicit Scope(const QString &command);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        void setOutputSize(qint64 size)     { sample.outputSize = size; }
+        void beginParse();
+        void endParse();
+
+    private:
+        void start(const QString &command);
+
+        bool active = false;
+        qint64 lockWaitAtStart = 0;
+        QElapsedTimer parseTimer;
+        Sample sample;
+    };
+
+    /**
+     * @brief Labels the commands issued by the current thread while it is alive,
+     * e.g. with the name of the widget being refreshed.
+     */
+    class IAITO_EXPORT Context
+    {
+    public:
+        explicit Context(const QString &name);
+        ~Context();
+        Context(const Context &) = delete;
+        Context &operator=(const Context &) = delete;
+
+    private:
+        QString previous;
+    };
+
+    static CommandProfiler *instance();
+
+    bool isEnabled() const              { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Account time the current thread spent waiting for the core lock.
+     */
+    static void addLockWait(qint64 waitNs);
+
+    void record(Sample sample);
+    /**
+     * @brief Record a command that was started at \a startNs (see now()) and just finished.
+     */
+    void recordFinished(const QString &command, qint64 startNs, qint64 outputSize);
+    qint64 now() const                  { return clock.nsecsElapsed(); }
+
+    QList<Stats> getStats() const;
+    void reset();
+
+    /**
+     * @brief Recent samples in the Chrome trace event JSON format.
+     */
+    QByteArray toChromeTrace() const;
+
+    static QString commandName(const QString &command);
+    static QString currentContext();
+
+signals:
+    void enabledChanged(bool enabled);
+
+private:
+    explicit CommandProfiler(QObject *parent = nullptr);
+
+    std::atomic<bool> enabled { false };
+    QElapsedTimer clock;
+
+    mutable QMutex mutex;
+    QHash<QString, Stats> stats;
+    QVector<Sample> samples;
+    int nextSample = 0;
+    QHash<quintptr, int> threadIndices;
+
+    int threadIndex();
+};
+
+#endif // COMMANDPROFILER_H
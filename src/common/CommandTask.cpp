@@ -10,7 +10,7 @@ CommandTask::CommandTask(const QString &cmd, ColorMode colorMode, bool outFormat
 void CommandTask::runTask() {
     TempConfig tempConfig;
     tempConfig.set("scr.color", colorMode);
-    auto res = Core()->cmdTask(cmd);
+    auto res = Core()->cmdTask(cmd, this);
     if (outFormatHtml) {
         res = IaitoCore::ansiEscapeToHtml(res);
     }
@@ -15,6 +15,7 @@ public:
     CommandTask(const QString &cmd, ColorMode colorMode=ColorMode::DISABLED, bool outFormatHtml=false);
 
     QString getTitle() override                     { return tr("Running Command"); }
+    Priority getPriority() override                 { return Priority::Interactive; }
 
 signals:
     void finished(const QString &result);
@@ -740,6 +740,26 @@ void Configuration::setDecompilerAutoRefreshEnabled(bool enabled)
     s.setValue("decompilerAutoRefresh", enabled);
 }
 
+bool Configuration::getAnalysisCacheEnabled()
+{
+    return s.value("analysisCache", true).toBool();
+}
+
+void Configuration::setAnalysisCacheEnabled(bool enabled)
+{
+    s.setValue("analysisCache", enabled);
+}
+
+qint64 Configuration::getAnalysisCacheMaxSize()
+{
+    return s.value("analysisCacheMaxSize", 1024ll * 1024 * 1024).toLongLong();
+}
+
+void Configuration::setAnalysisCacheMaxSize(qint64 size)
+{
+    s.setValue("analysisCacheMaxSize", size);
+}
+
 void Configuration::enableDecompilerAnnotationHighlighter(bool useDecompilerHighlighter)
 {
     s.setValue("decompilerAnnotationHighlighter", useDecompilerHighlighter);
@@ -163,6 +163,17 @@ public:
     bool getDecompilerAutoRefreshEnabled();
     void setDecompilerAutoRefreshEnabled(bool enabled);
 
+    /**
+     * @brief Whether opening a file reuses the analysis of an identical one, see AnalysisCache
+     */
+    bool getAnalysisCacheEnabled();
+    void setAnalysisCacheEnabled(bool enabled);
+    /**
+     * @return bytes the analysis cache may take on disk
+     */
+    qint64 getAnalysisCacheMaxSize();
+    void setAnalysisCacheMaxSize(qint64 size);
+
     void enableDecompilerAnnotationHighlighter(bool useDecompilerHighlighter);
     bool isDecompilerAnnotationHighlighterEnabled();
 
@@ -176,6 +187,30 @@ public:
         s.setValue("graph.maxcols", ch);
     }
 
+    // Hexdump
+    /**
+     * @brief Number of 4 KiB memory blocks kept by each hexdump for scrolling
+     */
+    int getHexdumpBlockCacheSize() const
+    {
+        return s.value("hexdump.blockCacheSize", 256).toInt();
+    }
+    void setHexdumpBlockCacheSize(int blocks)
+    {
+        s.setValue("hexdump.blockCacheSize", blocks);
+    }
+    /**
+     * @brief Draw the hexdump from pre-rendered glyphs instead of laying out text per byte
+     */
+    bool getHexdumpGlyphAtlas() const
+    {
+        return s.value("hexdump.glyphAtlas", true).toBool();
+    }
+    void setHexdumpGlyphAtlas(bool enabled)
+    {
+        s.setValue("hexdump.glyphAtlas", enabled);
+    }
+
     /**
      * @brief Getters and setters for the transaparent option state and scale factor for bitmap graph exports.
      */
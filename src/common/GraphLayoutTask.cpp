@@ -0,0 +1,22 @@
+#include "GraphLayoutTask.h"
+
+GraphLayoutTask::GraphLayoutTask(std::unique_ptr<GraphLayout> layout,
+                                 const GraphLayout::Graph &blocks, ut64 entry)
+    : layout(std::move(layout)), blocks(blocks), entry(entry)
+{
+    this->layout->setCancelFlag(&cancelled);
+}
+
+void GraphLayoutTask::interrupt()
+{
+    cancelled = true;
+    AsyncTask::interrupt();
+}
+
+void GraphLayoutTask::runTask()
+{
+    layout->CalculateLayout(blocks, entry, width, height);
+    if (!cancelled) {
+        emit layoutFinished();
+    }
+}
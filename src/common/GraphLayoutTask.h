@@ -0,0 +1,52 @@
+#ifndef GRAPHLAYOUTTASK_H
+#define GRAPHLAYOUTTASK_H
+
+#include "common/AsyncTask.h"
+#include "widgets/GraphLayout.h"
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Calculates a graph layout on a copy of the blocks, so that large graphs
+ * do not block the GUI thread.
+ */
+class GraphLayoutTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param layout independent layout, see GraphLayout::clone()
+     */
+    GraphLayoutTask(std::unique_ptr<GraphLayout> layout, const GraphLayout::Graph &blocks, ut64 entry);
+
+    QString getTitle() override                     { return tr("Graph Layout"); }
+    void interrupt() override;
+
+    /**
+     * @brief Blocks with their calculated positions, valid once the task finished without interruption
+     */
+    const GraphLayout::Graph &getBlocks() const     { return blocks; }
+    int getWidth() const                            { return width; }
+    int getHeight() const                           { return height; }
+
+signals:
+    /**
+     * @brief Not emitted if the task was interrupted
+     */
+    void layoutFinished();
+
+protected:
+    void runTask() override;
+
+private:
+    std::unique_ptr<GraphLayout> layout;
+    GraphLayout::Graph blocks;
+    ut64 entry;
+    int width = 0;
+    int height = 0;
+    std::atomic<bool> cancelled { false };
+};
+
+#endif // GRAPHLAYOUTTASK_H
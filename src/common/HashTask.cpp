@@ -0,0 +1,79 @@
+#include "HashTask.h"
+
+#include <QCryptographicHash>
+
+#include <array>
+#include <cmath>
+
+static const int CHUNK_SIZE = 1024 * 1024;
+
+static const std::array<quint32, 256> &crc32Table()
+{
+    static const std::array<quint32, 256> table = []() -> std::array<quint32, 256> {
+        std::array<quint32, 256> ret;
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            ret[i] = c;
+        }
+        return ret;
+    }();
+    return table;
+}
+
+HashTask::HashTask(RVA address, int size)
+    : address(address), size(size), generation(Core()->getAnalysisGeneration())
+{
+}
+
+void HashTask::runTask()
+{
+    QCryptographicHash md5(QCryptographicHash::Md5);
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+    QCryptographicHash sha256(QCryptographicHash::Sha256);
+    const auto &crcTable = crc32Table();
+    quint32 crc = 0xffffffff;
+    std::array<quint64, 256> histogram {};
+
+    int lastPercent = -1;
+    for (int offset = 0; offset < size; offset += CHUNK_SIZE) {
+        if (isInterrupted()) {
+            return;
+        }
+        // Every chunk takes the core lock on its own, commands from the GUI get in between
+        const QByteArray chunk = Core()->ioRead(address + offset, std::min(CHUNK_SIZE, size - offset));
+        md5.addData(chunk);
+        sha1.addData(chunk);
+        sha256.addData(chunk);
+        for (char c : chunk) {
+            const quint8 byte = static_cast<quint8>(c);
+            crc = crcTable[(crc ^ byte) & 0xff] ^ (crc >> 8);
+            histogram[byte]++;
+        }
+
+        const int percent = static_cast<int>((offset + chunk.size()) * 100ll / size);
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            setProgress(percent);
+        }
+    }
+
+    double entropy = 0;
+    for (quint64 count : histogram) {
+        if (count) {
+            const double p = static_cast<double>(count) / size;
+            entropy -= p * std::log2(p);
+        }
+    }
+
+    QStringList hashes;
+    hashes.reserve(ResultCount);
+    hashes << QString::fromLatin1(md5.result().toHex())
+           << QString::fromLatin1(sha1.result().toHex())
+           << QString::fromLatin1(sha256.result().toHex())
+           << QString("%1").arg(crc ^ 0xffffffff, 8, 16, QLatin1Char('0'))
+           << QString::number(entropy, 'f', 6);
+    emit hashFinished(hashes);
+}
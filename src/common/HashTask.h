@@ -0,0 +1,44 @@
+#ifndef HASHTASK_H
+#define HASHTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Iaito.h"
+
+/**
+ * @brief Computes md5, sha1, sha256, crc32 and the entropy of a memory range
+ * in a single pass, reading it in chunks so that it can be interrupted.
+ */
+class HashTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    enum Result { MD5, SHA1, SHA256, CRC32, Entropy, ResultCount };
+
+    HashTask(RVA address, int size);
+
+    QString getTitle() override                     { return tr("Hashing Selection"); }
+
+    RVA getAddress() const                          { return address; }
+    int getSize() const                             { return size; }
+    /**
+     * @brief Analysis generation the data was read at
+     */
+    quint64 getGeneration() const                   { return generation; }
+
+signals:
+    /**
+     * @param hashes indexed by Result, not emitted if the task was interrupted
+     */
+    void hashFinished(const QStringList &hashes);
+
+protected:
+    void runTask() override;
+
+private:
+    RVA address;
+    int size;
+    quint64 generation;
+};
+
+#endif // HASHTASK_H
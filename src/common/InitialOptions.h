@@ -39,6 +39,8 @@ struct InitialOptions
     QString script;
     
     QList<CommandDescription> analCmd = { {"aaa", "Auto analysis"} };
+    /** Skip analCmd if an identical file was analyzed the same way before, see AnalysisCache */
+    bool useAnalysisCache = false;
 
     QString shellcode;
 };
@@ -0,0 +1,124 @@
+#include "InstructionIndex.h"
+
+#include <algorithm>
+
+int InstructionIndex::boundaryIndex(const Run &run, RVA addr)
+{
+    if (addr == run.end) {
+        return run.starts.size();
+    }
+    auto it = std::lower_bound(run.starts.constBegin(), run.starts.constEnd(), addr);
+    if (it == run.starts.constEnd() || *it != addr) {
+        return -1;
+    }
+    return static_cast<int>(it - run.starts.constBegin());
+}
+
+QMap<RVA, InstructionIndex::Run>::const_iterator InstructionIndex::findRun(RVA addr) const
+{
+    auto it = runs.upperBound(addr);
+    if (it == runs.constBegin()) {
+        return runs.constEnd();
+    }
+    --it;
+    return addr < it->end ? it : runs.constEnd();
+}
+
+void InstructionIndex::insert(Run run)
+{
+    if (run.starts.isEmpty()) {
+        return;
+    }
+
+    // Instructions of disagreeing runs that do not overlap this one, inserted after the loop
+    QVector<Run> kept;
+    auto it = runs.upperBound(run.starts.first());
+    if (it != runs.begin()) {
+        --it;
+    }
+    while (it != runs.end() && it.key() <= run.end) {
+        const Run &other = it.value();
+        if (other.end < run.starts.first()) {
+            ++it;
+            continue;
+        }
+        // Keep what the other run knows beyond this one. If both agree where they meet the
+        // runs are joined, otherwise only the instructions entirely outside this one remain.
+        if (other.starts.first() < run.starts.first()) {
+            const int i = boundaryIndex(other, run.starts.first());
+            if (i > 0) {
+                run.starts = other.starts.mid(0, i) + run.starts;
+            } else if (i < 0) {
+                const int p = static_cast<int>(std::upper_bound(other.starts.constBegin(),
+                                                                other.starts.constEnd(),
+                                                                run.starts.first())
+                                               - other.starts.constBegin()) - 1;
+                if (p > 0) {
+                    Run prefix;
+                    prefix.starts = other.starts.mid(0, p);
+                    prefix.end = other.starts[p];
+                    kept.append(prefix);
+                }
+            }
+        }
+        if (other.end > run.end) {
+            const int j = boundaryIndex(other, run.end);
+            if (j >= 0) {
+                run.starts += other.starts.mid(j);
+                run.end = other.end;
+            } else {
+                const int q = static_cast<int>(std::lower_bound(other.starts.constBegin(),
+                                                                other.starts.constEnd(),
+                                                                run.end)
+                                               - other.starts.constBegin());
+                if (q < other.starts.size()) {
+                    Run suffix;
+                    suffix.starts = other.starts.mid(q);
+                    suffix.end = other.end;
+                    kept.append(suffix);
+                }
+            }
+        }
+        it = runs.erase(it);
+    }
+    runs.insert(run.starts.first(), run);
+    for (const Run &k : kept) {
+        runs.insert(k.starts.first(), k);
+    }
+}
+
+RVA InstructionIndex::step(RVA addr, int count) const
+{
+    auto it = findRun(addr);
+    if (it == runs.constEnd() && count < 0) {
+        // A run ending right at addr, as left by decoding backwards, knows what precedes it
+        it = runs.upperBound(addr);
+        if (it == runs.constBegin() || (--it)->end != addr) {
+            it = runs.constEnd();
+        }
+    }
+    if (it == runs.constEnd()) {
+        return RVA_INVALID;
+    }
+    const int i = boundaryIndex(it.value(), addr);
+    if (i < 0) {
+        return RVA_INVALID;
+    }
+    const qint64 target = static_cast<qint64>(i) + count;
+    if (target < 0 || target > it->starts.size()) {
+        return RVA_INVALID;
+    }
+    return target == it->starts.size() ? it->end : it->starts[static_cast<int>(target)];
+}
+
+bool InstructionIndex::isBoundary(RVA addr) const
+{
+    auto it = findRun(addr);
+    return it != runs.constEnd() && boundaryIndex(it.value(), addr) >= 0;
+}
+
+RVA InstructionIndex::runStart(RVA addr) const
+{
+    auto it = findRun(addr);
+    return it != runs.constEnd() ? it.key() : RVA_INVALID;
+}
@@ -0,0 +1,62 @@
+#ifndef INSTRUCTIONINDEX_H
+#define INSTRUCTIONINDEX_H
+
+#include "core/IaitoCommon.h"
+
+#include <QMap>
+#include <QVector>
+
+/**
+ * @brief Sorted instruction start addresses for stepping through the disassembly
+ * by a number of instructions without decoding it again.
+ *
+ * The index is made of runs of consecutive instructions, each one ending where the
+ * next one starts. Runs that overlap or touch are joined when they agree on a boundary.
+ * Otherwise the newer run wins and only the instructions of the older one that do not
+ * overlap it are kept.
+ */
+class IAITO_EXPORT InstructionIndex
+{
+public:
+    struct Run {
+        /** Start of every instruction, ascending */
+        QVector<RVA> starts;
+        /** Address right after the last instruction */
+        RVA end = 0;
+    };
+
+    void clear()                        { runs.clear(); }
+    bool isEmpty() const                { return runs.isEmpty(); }
+
+    void insert(Run run);
+
+    /**
+     * @brief Start of the instruction \a count instructions after (or before, if negative) the
+     * one starting at \a addr.
+     * For negative counts \a addr may also be the end of a run.
+     * @return RVA_INVALID if \a addr or the result is not covered by a single run
+     */
+    RVA step(RVA addr, int count) const;
+
+    /**
+     * @brief Whether \a addr is the start of an indexed instruction
+     */
+    bool isBoundary(RVA addr) const;
+
+    /**
+     * @brief First address of the run containing \a addr, RVA_INVALID if there is none
+     */
+    RVA runStart(RVA addr) const;
+
+private:
+    /** Runs by the address of their first instruction */
+    QMap<RVA, Run> runs;
+
+    QMap<RVA, Run>::const_iterator findRun(RVA addr) const;
+    /**
+     * @return i with run.starts[i] == addr, run.starts.size() if addr is run.end, -1 otherwise
+     */
+    static int boundaryIndex(const Run &run, RVA addr);
+};
+
+#endif // INSTRUCTIONINDEX_H
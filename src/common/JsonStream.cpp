@@ -0,0 +1,409 @@
+#include "common/JsonStream.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <cstdlib>
+#include <cstring>
+
+static const char *skipWhitespace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @return pointer past the closing quote of the string starting at p, or nullptr
+ */
+static const char *skipString(const char *p, const char *end)
+{
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @return pointer past the value starting at p, or nullptr if it is malformed
+ */
+static const char *skipValue(const char *p, const char *end)
+{
+    if (p >= end) {
+        return nullptr;
+    }
+    if (*p == '"') {
+        return skipString(p, end);
+    }
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            switch (*p) {
+            case '"':
+                p = skipString(p, end);
+                if (!p) {
+                    return nullptr;
+                }
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    return p + 1;
+                }
+                break;
+            default:
+                break;
+            }
+            p++;
+        }
+        return nullptr;
+    }
+    const char *start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']'
+            && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+        p++;
+    }
+    return p != start ? p : nullptr;
+}
+
+/**
+ * @brief Copy a number literal into a NUL terminated buffer for strto*()
+ */
+static bool copyNumber(const char *begin, const char *end, char (&out)[64])
+{
+    size_t len = end - begin;
+    if (len == 0 || len >= sizeof(out)) {
+        return false;
+    }
+    memcpy(out, begin, len);
+    out[len] = '\0';
+    return true;
+}
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+QString JsonStream::parseString(const char *begin, const char *end)
+{
+    if (end - begin < 2 || *begin != '"') {
+        return QString();
+    }
+    begin++;
+    end--;
+    const char *escape = static_cast<const char *>(memchr(begin, '\\', end - begin));
+    if (!escape) {
+        return QString::fromUtf8(begin, static_cast<int>(end - begin));
+    }
+
+    QString ret = QString::fromUtf8(begin, static_cast<int>(escape - begin));
+    QByteArray pending;
+    auto flush = [&]() {
+        if (!pending.isEmpty()) {
+            ret += QString::fromUtf8(pending);
+            pending.clear();
+        }
+    };
+    for (const char *p = escape; p < end; p++) {
+        if (*p != '\\' || p + 1 >= end) {
+            pending.append(*p);
+            continue;
+        }
+        p++;
+        switch (*p) {
+        case 'b': pending.append('\b'); break;
+        case 'f': pending.append('\f'); break;
+        case 'n': pending.append('\n'); break;
+        case 'r': pending.append('\r'); break;
+        case 't': pending.append('\t'); break;
+        case 'u': {
+            if (end - p < 5) {
+                return ret;
+            }
+            ushort code = 0;
+            for (int i = 1; i <= 4; i++) {
+                int d = hexDigit(p[i]);
+                if (d < 0) {
+                    return ret;
+                }
+                code = static_cast<ushort>((code << 4) | d);
+            }
+            p += 4;
+            flush();
+            ret += QChar(code);
+            break;
+        }
+        default:
+            // '"', '\\' and '/'
+            pending.append(*p);
+            break;
+        }
+    }
+    flush();
+    return ret;
+}
+
+QJsonValue JsonStream::parseValue(const char *begin, const char *end)
+{
+    begin = skipWhitespace(begin, end);
+    if (begin >= end) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    switch (*begin) {
+    case '"':
+        return parseString(begin, end);
+    case '{':
+    case '[': {
+        // Only this sub-tree is materialized, the data is not copied
+        QByteArray raw = QByteArray::fromRawData(begin, static_cast<int>(end - begin));
+        QJsonDocument doc = QJsonDocument::fromJson(raw);
+        if (doc.isObject()) {
+            return doc.object();
+        }
+        if (doc.isArray()) {
+            return doc.array();
+        }
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    case 't':
+        return true;
+    case 'f':
+        return false;
+    case 'n':
+        return QJsonValue(QJsonValue::Null);
+    default: {
+        char num[64];
+        if (!copyNumber(begin, end, num)) {
+            return QJsonValue(QJsonValue::Undefined);
+        }
+        return strtod(num, nullptr);
+    }
+    }
+}
+
+bool JsonStream::forEachArrayElement(const char *buf, size_t len,
+                                     const std::function<bool(const char *, const char *)> &callback)
+{
+    const char *end = buf + len;
+    const char *p = skipWhitespace(buf, end);
+    if (p >= end || *p != '[') {
+        return false;
+    }
+    p = skipWhitespace(p + 1, end);
+    if (p < end && *p == ']') {
+        return true;
+    }
+    while (p < end) {
+        const char *valueEnd = skipValue(p, end);
+        if (!valueEnd) {
+            return false;
+        }
+        if (!callback(p, valueEnd)) {
+            return true;
+        }
+        p = skipWhitespace(valueEnd, end);
+        if (p >= end) {
+            return false;
+        }
+        if (*p == ']') {
+            return true;
+        }
+        if (*p != ',') {
+            return false;
+        }
+        p = skipWhitespace(p + 1, end);
+    }
+    return false;
+}
+
+JsonStreamObject::JsonStreamObject(const char *begin, const char *end)
+{
+    const char *p = skipWhitespace(begin, end);
+    if (p >= end || *p != '{') {
+        return;
+    }
+    p = skipWhitespace(p + 1, end);
+    if (p < end && *p == '}') {
+        valid = true;
+        return;
+    }
+    while (p < end) {
+        if (*p != '"') {
+            return;
+        }
+        const char *keyEnd = skipString(p, end);
+        if (!keyEnd) {
+            return;
+        }
+        Member member;
+        member.key = p + 1;
+        member.keyLength = static_cast<int>(keyEnd - p - 2);
+
+        p = skipWhitespace(keyEnd, end);
+        if (p >= end || *p != ':') {
+            return;
+        }
+        p = skipWhitespace(p + 1, end);
+        member.begin = p;
+        member.end = skipValue(p, end);
+        if (!member.end) {
+            return;
+        }
+        members.append(member);
+
+        p = skipWhitespace(member.end, end);
+        if (p >= end) {
+            return;
+        }
+        if (*p == '}') {
+            valid = true;
+            return;
+        }
+        if (*p != ',') {
+            return;
+        }
+        p = skipWhitespace(p + 1, end);
+    }
+}
+
+const JsonStreamObject::Member *JsonStreamObject::find(const char *key) const
+{
+    // r2 objects only have a handful of keys, a linear scan beats hashing them
+    const int keyLength = static_cast<int>(strlen(key));
+    for (const Member &member : members) {
+        if (member.keyLength == keyLength && !memcmp(member.key, key, keyLength)) {
+            return &member;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonStreamObject::isNull(const char *key) const
+{
+    const Member *member = find(key);
+    return !member || *member->begin == 'n';
+}
+
+QString JsonStreamObject::toString(const char *key, const QString &defaultValue) const
+{
+    const Member *member = find(key);
+    if (!member || *member->begin != '"') {
+        return defaultValue;
+    }
+    return JsonStream::parseString(member->begin, member->end);
+}
+
+ut64 JsonStreamObject::toULongLong(const char *key, ut64 defaultValue) const
+{
+    const Member *member = find(key);
+    char num[64];
+    if (!member || !copyNumber(member->begin, member->end, num)) {
+        return defaultValue;
+    }
+    // Parse the literal directly, going through double would lose precision on 64-bit addresses
+    char *numEnd = nullptr;
+    ut64 ret = strtoull(num, &numEnd, 10);
+    if (numEnd == num) {
+        return defaultValue;
+    }
+    if (*numEnd == '.' || *numEnd == 'e' || *numEnd == 'E') {
+        return static_cast<ut64>(strtod(num, nullptr));
+    }
+    return ret;
+}
+
+st64 JsonStreamObject::toLongLong(const char *key, st64 defaultValue) const
+{
+    const Member *member = find(key);
+    char num[64];
+    if (!member || !copyNumber(member->begin, member->end, num)) {
+        return defaultValue;
+    }
+    char *numEnd = nullptr;
+    st64 ret = strtoll(num, &numEnd, 10);
+    if (numEnd == num) {
+        return defaultValue;
+    }
+    return ret;
+}
+
+int JsonStreamObject::toInt(const char *key, int defaultValue) const
+{
+    return static_cast<int>(toLongLong(key, defaultValue));
+}
+
+double JsonStreamObject::toDouble(const char *key, double defaultValue) const
+{
+    const Member *member = find(key);
+    char num[64];
+    if (!member || !copyNumber(member->begin, member->end, num)) {
+        return defaultValue;
+    }
+    char *numEnd = nullptr;
+    double ret = strtod(num, &numEnd);
+    return numEnd == num ? defaultValue : ret;
+}
+
+bool JsonStreamObject::toBool(const char *key, bool defaultValue) const
+{
+    const Member *member = find(key);
+    if (!member) {
+        return defaultValue;
+    }
+    if (*member->begin == 't') {
+        return true;
+    }
+    if (*member->begin == 'f') {
+        return false;
+    }
+    return defaultValue;
+}
+
+QJsonValue JsonStreamObject::value(const char *key) const
+{
+    const Member *member = find(key);
+    if (!member) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return JsonStream::parseValue(member->begin, member->end);
+}
+
+bool JsonStreamObject::forEachObject(const char *key,
+                                     const std::function<bool(const JsonStreamObject &)> &callback) const
+{
+    const Member *member = find(key);
+    if (!member || *member->begin != '[') {
+        return false;
+    }
+    bool ok = true;
+    bool parsed = JsonStream::forEachArrayElement(member->begin, member->end - member->begin,
+                                                  [&](const char *begin, const char *end) {
+        JsonStreamObject object(begin, end);
+        if (!object.isValid()) {
+            ok = false;
+            return false;
+        }
+        return callback(object);
+    });
+    return parsed && ok;
+}
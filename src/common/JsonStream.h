@@ -0,0 +1,81 @@
+#ifndef IAITO_JSONSTREAM_H
+#define IAITO_JSONSTREAM_H
+
+#include "core/IaitoCommon.h"
+
+#include <QJsonValue>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Read-only view over a JSON object stored in an externally owned buffer.
+ *
+ * Only the top level members are tokenized, values are decoded lazily when
+ * requested, so iterating a big array of small objects never builds a DOM.
+ * The buffer must outlive the object.
+ */
+class IAITO_EXPORT JsonStreamObject
+{
+public:
+    JsonStreamObject(const char *begin, const char *end);
+
+    bool isValid() const                        { return valid; }
+    bool contains(const char *key) const        { return find(key) != nullptr; }
+    bool isNull(const char *key) const;
+
+    QString toString(const char *key, const QString &defaultValue = QString()) const;
+    ut64 toULongLong(const char *key, ut64 defaultValue = 0) const;
+    st64 toLongLong(const char *key, st64 defaultValue = 0) const;
+    int toInt(const char *key, int defaultValue = 0) const;
+    double toDouble(const char *key, double defaultValue = 0.0) const;
+    bool toBool(const char *key, bool defaultValue = false) const;
+
+    /**
+     * @brief Decode a single member, nested objects and arrays are parsed on demand.
+     */
+    QJsonValue value(const char *key) const;
+
+    /**
+     * @brief Call \a callback for every object of the nested array \a key.
+     * @return false if the member is not an array of objects
+     */
+    bool forEachObject(const char *key, const std::function<bool(const JsonStreamObject &)> &callback) const;
+
+private:
+    struct Member {
+        const char *key;
+        int keyLength;
+        const char *begin;
+        const char *end;
+    };
+
+    const Member *find(const char *key) const;
+
+    QVector<Member> members;
+    bool valid = false;
+};
+
+namespace JsonStream {
+
+/**
+ * @brief Tokenize \a buf in place and call \a callback with the bounds of every
+ * element of its top level array. Iteration stops when \a callback returns false.
+ * @return false if the buffer is not a well-formed JSON array
+ */
+IAITO_EXPORT bool forEachArrayElement(const char *buf, size_t len,
+                                      const std::function<bool(const char *, const char *)> &callback);
+
+/**
+ * @brief Decode a single JSON value spanning [begin, end).
+ */
+IAITO_EXPORT QJsonValue parseValue(const char *begin, const char *end);
+
+/**
+ * @brief Decode a JSON string literal spanning [begin, end), quotes included.
+ */
+IAITO_EXPORT QString parseString(const char *begin, const char *end);
+
+}
+
+#endif //IAITO_JSONSTREAM_H
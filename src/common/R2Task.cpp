@@ -24,6 +24,10 @@ void R2Task::taskFinishedCallback(void *user, char *)
 
 void R2Task::taskFinished()
 {
+    if (!IaitoCore::isReadOnlyCommand(task->cmd)) {
+        Core()->bumpAnalysisGeneration();
+    }
+    finishedSemaphore.release();
     emit finished();
 }
 
@@ -42,6 +46,15 @@ void R2Task::joinTask()
     r_core_task_join(&Core()->core_->tasks, nullptr, task->id);
 }
 
+bool R2Task::waitFinished(int timeout)
+{
+    if (!finishedSemaphore.tryAcquire(1, timeout)) {
+        return false;
+    }
+    finishedSemaphore.release();
+    return true;
+}
+
 QString R2Task::getResult()
 {
     return QString::fromUtf8(task->res);
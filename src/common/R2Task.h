@@ -4,12 +4,15 @@
 
 #include "core/Iaito.h"
 
+#include <QSemaphore>
+
 class R2Task: public QObject
 {
     Q_OBJECT
 
 private:
     RCoreTask *task;
+    QSemaphore finishedSemaphore;
 
     static void taskFinishedCallback(void *user, char *);
     void taskFinished();
@@ -23,6 +26,11 @@ public:
     void startTask();
     void breakTask();
     void joinTask();
+    /**
+     * @brief Wait for the command to finish without joining it
+     * @return false if it is still running after timeout milliseconds
+     */
+    bool waitFinished(int timeout);
 
     QString getResult();
     QJsonDocument getResultJson();
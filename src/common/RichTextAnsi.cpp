@@ -0,0 +1,218 @@
+#include "RichTextPainter.h"
+
+#include <algorithm>
+
+// ANSI escape parsing and HTML output of RichTextPainter, kept apart from the painting
+// code since they only need QtGui types and are used by the tests on their own
+
+static QColor ansiColor256(int index)
+{
+    static const QRgb basic[16] = {
+        0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+        0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff
+    };
+    if (index < 16) {
+        return QColor(basic[index]);
+    }
+    if (index < 232) {
+        static const int levels[6] = { 0, 95, 135, 175, 215, 255 };
+        index -= 16;
+        return QColor(levels[index / 36], levels[(index / 6) % 6], levels[index % 6]);
+    }
+    int gray = 8 + (index - 232) * 10;
+    return QColor(gray, gray, gray);
+}
+
+/**
+ * @brief Apply the parameters of one "ESC [ ... m" sequence
+ */
+static void applySgr(const QVector<int> &params, QColor &fg, QColor &bg)
+{
+    if (params.isEmpty()) {
+        fg = bg = QColor();
+        return;
+    }
+    for (int i = 0; i < params.size(); i++) {
+        int p = params[i];
+        if (p == 0) {
+            fg = bg = QColor();
+        } else if (p >= 30 && p <= 37) {
+            fg = ansiColor256(p - 30);
+        } else if (p >= 90 && p <= 97) {
+            fg = ansiColor256(p - 90 + 8);
+        } else if (p >= 40 && p <= 47) {
+            bg = ansiColor256(p - 40);
+        } else if (p >= 100 && p <= 107) {
+            bg = ansiColor256(p - 100 + 8);
+        } else if (p == 39) {
+            fg = QColor();
+        } else if (p == 49) {
+            bg = QColor();
+        } else if (p == 38 || p == 48) {
+            QColor color;
+            if (i + 2 < params.size() && params[i + 1] == 5) {
+                color = ansiColor256(qBound(0, params[i + 2], 255));
+                i += 2;
+            } else if (i + 4 < params.size() && params[i + 1] == 2) {
+                color = QColor(qBound(0, params[i + 2], 255), qBound(0, params[i + 3], 255),
+                               qBound(0, params[i + 4], 255));
+                i += 4;
+            } else {
+                break;
+            }
+            (p == 38 ? fg : bg) = color;
+        }
+        // bold, underline, inverse... are not rendered
+    }
+}
+
+RichTextPainter::List RichTextPainter::fromAnsi(const QString &text, QString *plainText)
+{
+    List r;
+    QColor fg;
+    QColor bg;
+    QString run;
+    QVector<int> params;
+
+    auto flush = [&]() {
+        if (run.isEmpty()) {
+            return;
+        }
+        CustomRichText_t richText;
+        richText.text = run;
+        richText.textColor = fg;
+        richText.textBackground = bg;
+        if (fg.isValid()) {
+            richText.flags = bg.isValid() ? FlagAll : FlagColor;
+        } else {
+            richText.flags = bg.isValid() ? FlagBackground : FlagNone;
+        }
+        r.push_back(richText);
+        if (plainText) {
+            *plainText += run;
+        }
+        run.clear();
+    };
+
+    const QChar *data = text.constData();
+    const int size = text.size();
+    int i = 0;
+    while (i < size) {
+        if (data[i] != QChar(0x1b)) {
+            int start = i;
+            while (i < size && data[i] != QChar(0x1b)) {
+                i++;
+            }
+            run.append(data + start, i - start);
+            continue;
+        }
+        // ESC
+        i++;
+        if (i >= size || data[i] != QLatin1Char('[')) {
+            // Not a CSI sequence, drop its intermediate bytes like in "ESC ( B" and the final one
+            while (i < size && data[i].unicode() >= 0x20 && data[i].unicode() <= 0x2f) {
+                i++;
+            }
+            i++;
+            continue;
+        }
+        i++;
+        params.clear();
+        int value = -1;
+        // Private markers like '?' and other parameter bytes make it a sequence
+        // that is not SGR, but it still has to be consumed up to its final byte
+        bool sgr = true;
+        while (i < size) {
+            ushort c = data[i].unicode();
+            if (c >= '0' && c <= '9') {
+                value = (value < 0 ? 0 : value * 10) + (c - '0');
+                value = std::min(value, 0xffff);
+            } else if (c == ';' || c == ':') {
+                params.append(value < 0 ? 0 : value);
+                value = -1;
+            } else if (c >= 0x20 && c <= 0x3f) {
+                // remaining parameter bytes (0x3c-0x3f) and intermediate bytes (0x20-0x2f)
+                sgr = false;
+            } else {
+                break;
+            }
+            i++;
+        }
+        if (value >= 0 || !params.isEmpty()) {
+            params.append(value < 0 ? 0 : value);
+        }
+        if (i >= size) {
+            break;
+        }
+        ushort terminator = data[i].unicode();
+        if (terminator < 0x40 || terminator > 0x7e) {
+            // Malformed, resume with the character as text
+            continue;
+        }
+        i++;
+        if (!sgr || terminator != 'm') {
+            // cursor movement, erase line, show or hide the cursor...
+            continue;
+        }
+        QColor newFg = fg;
+        QColor newBg = bg;
+        applySgr(params, newFg, newBg);
+        if (newFg != fg || newBg != bg) {
+            flush();
+            fg = newFg;
+            bg = newBg;
+        }
+    }
+    flush();
+
+    return r;
+}
+
+QString RichTextPainter::toHtml(const List &richText)
+{
+    QString html;
+    for (const CustomRichText_t &curRichText : richText) {
+        bool hasFg = curRichText.flags == FlagColor || curRichText.flags == FlagAll;
+        bool hasBg = curRichText.flags == FlagBackground || curRichText.flags == FlagAll;
+        if (hasFg && hasBg) {
+            html += QStringLiteral("<span style=\"color:%1;background-color:%2\">")
+                    .arg(curRichText.textColor.name(), curRichText.textBackground.name());
+        } else if (hasFg) {
+            html += QStringLiteral("<span style=\"color:%1\">").arg(curRichText.textColor.name());
+        } else if (hasBg) {
+            html += QStringLiteral("<span style=\"background-color:%1\">")
+                    .arg(curRichText.textBackground.name());
+        }
+        for (QChar c : curRichText.text) {
+            switch (c.unicode()) {
+            case '<':
+                html += QLatin1String("&lt;");
+                break;
+            case '>':
+                html += QLatin1String("&gt;");
+                break;
+            case '&':
+                html += QLatin1String("&amp;");
+                break;
+            case '"':
+                html += QLatin1String("&quot;");
+                break;
+            case ' ':
+                html += QLatin1String("&nbsp;");
+                break;
+            case '\n':
+                html += QLatin1String("<br />");
+                break;
+            case '\r':
+                break;
+            default:
+                html += c;
+                break;
+            }
+        }
+        if (hasFg || hasBg) {
+            html += QLatin1String("</span>");
+        }
+    }
+    return html;
+}
@@ -6,6 +6,8 @@
 #include <QTextBlock>
 #include <QTextFragment>
 
+#include <algorithm>
+
 //TODO: fix performance (possibly use QTextLayout?)
 
 
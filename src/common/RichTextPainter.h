@@ -44,6 +44,16 @@ public:
     static void htmlRichText(const List &richText, QString &textHtml, QString &textPlain);
 
     static List fromTextDocument(const QTextDocument &doc);
+    /**
+     * @brief Parse text with ANSI SGR color escapes in a single pass.
+     * Other escape sequences, including CSI ones with private or intermediate bytes, are dropped.
+     * @param plainText if not null, receives the text without any escapes
+     */
+    static List fromAnsi(const QString &text, QString *plainText = nullptr);
+    /**
+     * @brief HTML for QTextEdit, with spaces kept and newlines turned into line breaks
+     */
+    static QString toHtml(const List &richText);
 
     static List cropped(const List &richText, int maxCols, const QString &indicator = nullptr,
                         bool *croppedOut = nullptr);
@@ -21,7 +21,7 @@ void RunScriptTask::runTask()
 {
     if (!this->fileName.isNull()) {
         log(tr("Executing script..."));
-        Core()->cmdTask(". " + this->fileName);
+        Core()->cmdTask(". " + this->fileName, this);
         if (isInterrupted()) {
             return;
         }
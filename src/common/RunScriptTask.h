@@ -15,6 +15,9 @@ public:
     QString getTitle() override {
         return tr("Run Script");
     }
+    Priority getPriority() override {
+        return Priority::Interactive;
+    }
 
     void setFileName(const QString &fileName) {
         this->fileName = fileName;
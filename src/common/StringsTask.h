@@ -11,6 +11,7 @@ Q_OBJECT
 
 public:
     QString getTitle() override                     { return tr("Searching for Strings"); }
+    Priority getPriority() override                 { return Priority::Interactive; }
 
 signals:
     void stringSearchFinished(const QList<StringDescription> &strings);
@@ -19,7 +20,10 @@ protected:
     void runTask() override
     {
         auto strings = Core()->getAllStrings();
-        emit stringSearchFinished(strings);
+        // Superseded by a newer search
+        if (!isInterrupted()) {
+            emit stringSearchFinished(strings);
+        }
     }
 };
 
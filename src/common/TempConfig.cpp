@@ -4,6 +4,11 @@
 #include "core/Iaito.h"
 #include "TempConfig.h"
 
+TempConfig::TempConfig()
+{
+    Core()->beginTempConfig();
+}
+
 TempConfig::~TempConfig()
 {
     for (auto i = resetValues.constBegin(); i != resetValues.constEnd(); ++i) {
@@ -22,6 +27,7 @@ TempConfig::~TempConfig()
             break;
         }
     }
+    Core()->endTempConfig();
 }
 
 TempConfig &TempConfig::set(const QString &key, const QString &value)
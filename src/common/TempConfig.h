@@ -23,11 +23,15 @@
  *     // config automatically restored at the end of scope
  * }
  * \endcode
+ *
+ * Temporary changes only bump the analysis generation once restored, and only if
+ * an io.* or cfg.* key or the architecture was changed, so most leave cached query
+ * results of other views intact.
  */
 class IAITO_EXPORT TempConfig
 {
 public:
-    TempConfig() = default;
+    TempConfig();
     ~TempConfig();
 
     TempConfig &set(const QString &key, const QString &value);
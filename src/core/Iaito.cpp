@@ -6,7 +6,12 @@
 #include <QVector>
 #include <QStringList>
 #include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QHash>
+#include <QSet>
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
@@ -16,11 +21,15 @@
 #include "common/AsyncTask.h"
 #include "common/R2Task.h"
 #include "common/Json.h"
+#include "common/CommandProfiler.h"
+#include "common/RichTextPainter.h"
 #include "core/Iaito.h"
+#include "core/NativeDescriptions.h"
 #include "Decompiler.h"
 #include "r_asm.h"
 #include "r_core.h"
 #include "r_cmd.h"
+#include "r_hash.h"
 #include "sdb.h"
 
 Q_GLOBAL_STATIC(IaitoCore, uniqueInstance)
@@ -125,27 +134,109 @@ static QString fromOwnedCharPtr(char *str) {
     return result;
 }
 
-RCoreLocked::RCoreLocked(IaitoCore *core)
-    : core(core)
+namespace {
+
+/**
+ * @brief Moves the core offset to an address for the lifetime of the object, like
+ * r2's "@" does, without going through r_core_seek and the seek history.
+ *
+ * The block is read once at the target, the previous one is saved and copied back
+ * on destruction instead of being read again, unless the command may have changed it.
+ * Must only be used while holding the core lock.
+ */
+class TempOffset
 {
-    core->coreMutex.lock();
-    assert(core->coreLockDepth >= 0);
-    core->coreLockDepth++;
-    if (core->coreLockDepth == 1) {
-        assert(core->coreBed);
-        r_cons_sleep_end(core->coreBed);
-        core->coreBed = nullptr;
+public:
+    TempOffset(RCore *core, RVA address, bool mayWrite)
+        : core(core), oldOffset(core->offset), oldBlockSize(core->blocksize), mayWrite(mayWrite)
+    {
+        if (address == RVA_INVALID || address == oldOffset) {
+            moved = false;
+            return;
+        }
+        if (!mayWrite && core->block) {
+            oldBlock = QByteArray(reinterpret_cast<const char *>(core->block), static_cast<int>(core->blocksize));
+        }
+        core->offset = address;
+        r_core_block_read(core);
+    }
+
+    ~TempOffset()
+    {
+        if (!moved) {
+            return;
+        }
+        core->offset = oldOffset;
+        if (mayWrite || core->blocksize != oldBlockSize || oldBlock.size() != static_cast<int>(oldBlockSize)) {
+            r_core_block_read(core);
+        } else {
+            memcpy(core->block, oldBlock.constData(), oldBlockSize);
+        }
+    }
+
+    TempOffset(const TempOffset &) = delete;
+    TempOffset &operator=(const TempOffset &) = delete;
+
+private:
+    RCore *core;
+    RVA oldOffset;
+    ut32 oldBlockSize;
+    QByteArray oldBlock;
+    bool mayWrite;
+    bool moved = true;
+};
+
+/**
+ * @brief Whether \a cmd may modify the bytes of the current block
+ */
+bool isWriteCommand(const char *cmd)
+{
+    while (*cmd == ' ') {
+        cmd++;
+    }
+    return *cmd == 'w';
+}
+
+}
+
+// Depth of the core lock held by the current thread. QReadWriteLock can't be
+// locked for read by the thread holding it for write, so nested RCoreLocked
+// only take the real lock on the outermost level.
+static thread_local int exclusiveLockDepth = 0;
+static thread_local int sharedLockDepth = 0;
+
+RCoreLocked::RCoreLocked(IaitoCore *core, Mode mode)
+    : core(core), mode(mode)
+{
+    if (exclusiveLockDepth == 0 && sharedLockDepth == 0) {
+        core->acquireCoreLock(mode == Mode::Shared);
+        owner = true;
+    } else if (mode == Mode::Exclusive && exclusiveLockDepth == 0) {
+        // Upgrading would deadlock against the other readers, and going on with only
+        // the shared lock would let this thread modify r2 under the other readers' feet
+        qFatal("Exclusive core lock requested while holding a shared one");
+    }
+
+    if (mode == Mode::Exclusive) {
+        exclusiveLockDepth++;
+    } else {
+        sharedLockDepth++;
     }
 }
 
 RCoreLocked::~RCoreLocked()
 {
-    assert(core->coreLockDepth > 0);
-    core->coreLockDepth--;
-    if (core->coreLockDepth == 0) {
-        core->coreBed = r_cons_sleep_begin();
+    if (mode == Mode::Exclusive) {
+        assert(exclusiveLockDepth > 0);
+        exclusiveLockDepth--;
+    } else {
+        assert(sharedLockDepth > 0);
+        sharedLockDepth--;
+    }
+
+    if (owner) {
+        core->releaseCoreLock();
     }
-    core->coreMutex.unlock();
 }
 
 RCoreLocked::operator RCore *() const
@@ -159,6 +250,7 @@ RCore *RCoreLocked::operator->() const
 }
 
 #define CORE_LOCK() RCoreLocked core(this)
+#define CORE_LOCK_SHARED() RCoreLocked core(this, RCoreLocked::Mode::Shared)
 
 static void cutterREventCallback(REvent *, int type, void *user, void *data)
 {
@@ -168,10 +260,27 @@ static void cutterREventCallback(REvent *, int type, void *user, void *data)
 
 IaitoCore::IaitoCore(QObject *parent):
     QObject(parent)
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    , coreMutex(QMutex::Recursive)
-#endif
 {
+    // Direct connections, the generation must be bumped before any queued
+    // receiver of these signals gets to query the core again
+    auto bump = [this]() { bumpAnalysisGeneration(); };
+    connect(this, &IaitoCore::refreshAll, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::functionRenamed, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::varsChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::functionsChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::flagsChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::commentsChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::registersChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::instructionChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::breakpointsChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::refreshCodeViews, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::stackChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::codeRebased, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::switchedThread, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::switchedProcess, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::ioCacheChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::writeModeChanged, this, bump, Qt::DirectConnection);
+    connect(this, &IaitoCore::ioModeChanged, this, bump, Qt::DirectConnection);
 }
 
 IaitoCore *IaitoCore::instance()
@@ -246,6 +355,196 @@ RCoreLocked IaitoCore::core()
     return RCoreLocked(this);
 }
 
+RCoreLocked IaitoCore::coreShared()
+{
+    return RCoreLocked(this, RCoreLocked::Mode::Shared);
+}
+
+void IaitoCore::acquireCoreLock(bool shared)
+{
+    bool acquired = shared ? coreLock.tryLockForRead() : coreLock.tryLockForWrite();
+    if (!acquired) {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        if (shared) {
+            coreLock.lockForRead();
+        } else {
+            coreLock.lockForWrite();
+        }
+        const quint64 waitNs = static_cast<quint64>(waitTimer.nsecsElapsed());
+        CommandProfiler::addLockWait(static_cast<qint64>(waitNs));
+
+        lockStatContended++;
+        lockStatWaitNs += waitNs;
+        auto app = QCoreApplication::instance();
+        if (app && QThread::currentThread() == app->thread()) {
+            lockStatGuiContended++;
+            lockStatGuiWaitNs += waitNs;
+            quint64 max = lockStatGuiMaxWaitNs.load();
+            while (waitNs > max && !lockStatGuiMaxWaitNs.compare_exchange_weak(max, waitNs)) {
+            }
+        }
+    }
+    if (shared) {
+        lockStatShared++;
+    } else {
+        lockStatExclusive++;
+    }
+
+    QMutexLocker locker(&coreBedMutex);
+    assert(coreLockDepth >= 0);
+    if (coreLockDepth++ == 0) {
+        assert(coreBed);
+        r_cons_sleep_end(coreBed);
+        coreBed = nullptr;
+    }
+}
+
+void IaitoCore::releaseCoreLock()
+{
+    {
+        QMutexLocker locker(&coreBedMutex);
+        assert(coreLockDepth > 0);
+        if (--coreLockDepth == 0) {
+            coreBed = r_cons_sleep_begin();
+        }
+    }
+    coreLock.unlock();
+}
+
+CoreLockStats IaitoCore::getCoreLockStats() const
+{
+    CoreLockStats stats;
+    stats.exclusiveLocks = lockStatExclusive.load();
+    stats.sharedLocks = lockStatShared.load();
+    stats.contendedLocks = lockStatContended.load();
+    stats.totalWaitNs = lockStatWaitNs.load();
+    stats.guiThreadContendedLocks = lockStatGuiContended.load();
+    stats.guiThreadWaitNs = lockStatGuiWaitNs.load();
+    stats.maxGuiThreadWaitNs = lockStatGuiMaxWaitNs.load();
+    return stats;
+}
+
+void IaitoCore::resetCoreLockStats()
+{
+    lockStatExclusive = 0;
+    lockStatShared = 0;
+    lockStatContended = 0;
+    lockStatWaitNs = 0;
+    lockStatGuiContended = 0;
+    lockStatGuiWaitNs = 0;
+    lockStatGuiMaxWaitNs = 0;
+}
+
+QueryCacheStats IaitoCore::getQueryCacheStats() const
+{
+    QueryCacheStats stats;
+    stats.hits = queryCacheHits.load();
+    stats.misses = queryCacheMisses.load();
+    stats.generation = analysisGeneration.load();
+    return stats;
+}
+
+void IaitoCore::resetQueryCacheStats()
+{
+    queryCacheHits = 0;
+    queryCacheMisses = 0;
+}
+
+template<typename T, typename Func>
+T IaitoCore::cachedQuery(const QString &key, Func compute)
+{
+    // Read before computing, a change racing with compute() then leaves
+    // the entry with an outdated generation instead of a wrong result
+    const quint64 generation = analysisGeneration.load();
+    if (tempConfigCount.load()) {
+        // The result may depend on settings that are about to be restored
+        return compute();
+    }
+    {
+        QMutexLocker locker(&queryCacheMutex);
+        auto it = queryCache.constFind(key);
+        if (it != queryCache.constEnd() && it->generation == generation) {
+            queryCacheHits++;
+            return *std::static_pointer_cast<const T>(it->value);
+        }
+    }
+    queryCacheMisses++;
+
+    T result = compute();
+
+    QMutexLocker locker(&queryCacheMutex);
+    if (generation == analysisGeneration.load()) {
+        // Entries of older generations can never be hit again
+        for (auto it = queryCache.begin(); it != queryCache.end();) {
+            if (it->generation != generation) {
+                it = queryCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        queryCache.insert(key, { generation, std::make_shared<const T>(result) });
+    }
+    return result;
+}
+
+/**
+ * @brief Commands known to only read state, by name. Everything else, including
+ * scripts run with ".", is assumed to change something.
+ */
+static const QSet<QByteArray> READ_ONLY_COMMANDS = {
+    // print
+    "p8", "p8j", "pc", "pcj", "pd", "pdj", "pD", "pDj", "pdf", "pdfj", "pdJ", "pdr", "pdrj",
+    "pds", "pdsf", "pdsj", "pdc", "pdd", "pdg", "pdz", "pi", "pij", "pI", "pIj", "pif", "pifj",
+    "ps", "psj", "psz", "pszj", "psx", "px", "pxj", "pxw", "pxq", "pxr", "pxrj", "pxa", "pxd",
+    "pv", "pvj", "pf", "pfj", "p-", "p-j",
+    // bin info, "ib" reloads it and "idp" loads debug info
+    "i", "ij", "ii", "iij", "ie", "iej", "iE", "iEj", "ih", "ihj", "iS", "iSj", "iSS", "iSSj",
+    "iz", "izj", "izz", "izzj", "is", "isj", "iM", "iMj", "iL", "iLj", "iC", "iCj", "iV", "iVj",
+    "iR", "iRj", "ic", "icj", "iI", "iIj", "il", "ilj", "ir", "irj", "it", "itj", "ph",
+    // expressions and help
+    "?", "?v", "?vi", "?e", "?E", "?j",
+    // seeks only move the offset
+    "s", "sj", "s-", "s+", "sn", "sp",
+    // searches add hit flags, "/O" only prints an address
+    "/O",
+    // analysis listings and lookups
+    "afl", "aflj", "afll", "afllj", "aflc", "afi", "afij", "afn.", "afv", "afvj", "afvR", "afvRj",
+    "afvW", "afvWj", "afcl", "afcf", "agJ", "agj", "agf", "agcj", "ao", "aoj", "aeafj", "anj",
+    "avj", "ahj", "aai", "aaij", "axt", "axtj", "axf", "axfj", "axj", "axq",
+    // metadata, flags, types and signatures
+    "C", "Cj", "CC.", "CCj", "Cs.", "Cd.", "Cf.", "fj", "fd", "fdj", "fsj", "tj", "ts", "tsj",
+    "tt", "ttj", "tu", "tuj", "te", "tej", "tc", "tsc", "ttc", "tuc", "tec", "zj",
+    // files, maps, projects and the palette
+    "oj", "oLj", "omj", "om.", "Pj", "Pi", "Pnj", "ecj", "ecoj", "Lc", "Lcj", "Lj", "wcj",
+    // debugger state
+    "drj", "drr", "drrj", "drn", "dpj", "dptj", "dplj", "dmj", "dbj", "dbtj", "dLj",
+};
+
+bool IaitoCore::isReadOnlyCommand(const char *cmd)
+{
+    if (!cmd) {
+        return true;
+    }
+    while (*cmd == ' ') {
+        cmd++;
+    }
+    // Command sequences, subcommands, pipes and iterators may run anything
+    if (strpbrk(cmd, ";`|>") || strstr(cmd, "@@") || strstr(cmd, "$(")) {
+        return false;
+    }
+    const size_t len = strcspn(cmd, " @~");
+    if (len == 0) {
+        return true;
+    }
+    if (len == 1 && cmd[0] == 'e') {
+        // Only a plain "e key" read, not "e key=value", "e -key" or "e !key"
+        const char *args = cmd + 1;
+        return !strpbrk(args, "=!-");
+    }
+    return READ_ONLY_COMMANDS.contains(QByteArray::fromRawData(cmd, static_cast<int>(len)));
+}
+
 QDir IaitoCore::getIaitoRCDefaultDirectory() const
 {
     return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
@@ -292,7 +591,7 @@ void IaitoCore::loadDefaultIaitoRC()
 
 QList<QString> IaitoCore::sdbList(QString path)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<QString> list = QList<QString>();
     Sdb *root = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (root) {
@@ -314,7 +613,7 @@ static SdbListPtr makeSdbListPtr(SdbList *list)
 
 QList<QString> IaitoCore::sdbListKeys(QString path)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<QString> list = QList<QString>();
     Sdb *root = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (root) {
@@ -331,7 +630,7 @@ QList<QString> IaitoCore::sdbListKeys(QString path)
 
 QString IaitoCore::sdbGet(QString path, QString key)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     Sdb *db = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (db) {
         const char *val = sdb_const_get(db, key.toUtf8().constData(), 0);
@@ -357,10 +656,15 @@ QString IaitoCore::sanitizeStringForCommand(QString s)
 
 QString IaitoCore::cmd(const char *str)
 {
+    CommandProfiler::Scope profile(str);
     CORE_LOCK();
 
     RVA offset = core->offset;
     char *res = r_core_cmd_str(core, str);
+    if (!isReadOnlyCommand(str)) {
+        bumpAnalysisGeneration();
+    }
+    profile.setOutputSize(res ? static_cast<qint64>(strlen(res)) : 0);
     QString o = fromOwnedCharPtr(res);
 
     if (offset != core->offset) {
@@ -369,6 +673,49 @@ QString IaitoCore::cmd(const char *str)
     return o;
 }
 
+QStringList IaitoCore::cmdBatch(const QStringList &commands, RVA address)
+{
+    QStringList outputs;
+    outputs.reserve(commands.size());
+
+    bool mayWrite = false;
+    for (const QString &command : commands) {
+        mayWrite = mayWrite || command.trimmed().startsWith(QLatin1Char('w'));
+    }
+
+    CORE_LOCK();
+    RVA offset = core->offset;
+    {
+        TempOffset tempOffset(core, address, mayWrite);
+
+        r_cons_push();
+        core->cons->context->noflush = true;
+        for (const QString &command : commands) {
+            const QByteArray str = command.toUtf8();
+            CommandProfiler::Scope profile(str.constData());
+            const char *buffer = nullptr;
+            if (r_core_cmd(core, str.constData(), 0) != -1) {
+                r_cons_filter();
+                buffer = r_cons_get_buffer();
+            }
+            if (!isReadOnlyCommand(str.constData())) {
+                bumpAnalysisGeneration();
+            }
+            profile.setOutputSize(buffer ? static_cast<qint64>(strlen(buffer)) : 0);
+            outputs << QString::fromUtf8(buffer ? buffer : "");
+            // Drop this output and the grep state before the next command
+            r_cons_reset();
+        }
+        r_cons_pop();
+        r_cons_echo(NULL);
+    }
+
+    if (offset != core->offset) {
+        updateSeek();
+    }
+    return outputs;
+}
+
 bool IaitoCore::isRedirectableDebugee()
 {
     if (!currentlyDebugging || currentlyAttachedToPID != -1) {
@@ -424,9 +771,17 @@ bool IaitoCore::asyncCmd(const char *str, QSharedPointer<R2Task> &task)
     CORE_LOCK();
 
     RVA offset = core->offset;
+    auto profiler = CommandProfiler::instance();
+    const qint64 startNs = profiler->isEnabled() ? profiler->now() : -1;
+    const QString profiledCommand = startNs >= 0 ? QString::fromUtf8(str) : QString();
 
     task = QSharedPointer<R2Task>(new R2Task(str, true));
-    connect(task.data(), &R2Task::finished, task.data(), [this, offset, task] () {
+    connect(task.data(), &R2Task::finished, task.data(), [this, offset, task, startNs, profiledCommand] () {
+        if (startNs >= 0) {
+            CommandProfiler::instance()->recordFinished(profiledCommand, startNs,
+                                                        task->getResultRaw() ? strlen(task->getResultRaw()) : 0);
+        }
+
         CORE_LOCK();
 
         if (offset != core->offset) {
@@ -439,27 +794,31 @@ bool IaitoCore::asyncCmd(const char *str, QSharedPointer<R2Task> &task)
 
 QString IaitoCore::cmdRawAt(const char *cmd, RVA address)
 {
-    QString res;
-    RVA oldOffset = getOffset();
-    seekSilent(address);
-
-    res = cmdRaw(cmd);
+    CommandProfiler::Scope profile(cmd);
+    CORE_LOCK();
+    TempOffset tempOffset(core, address, isWriteCommand(cmd));
 
-    seekSilent(oldOffset);
+    QString res = cmdRaw(cmd);
+    profile.setOutputSize(res.size());
     return res;
 }
 
 QString IaitoCore::cmdRaw(const char *cmd)
 {
+    CommandProfiler::Scope profile(cmd);
     QString res;
     CORE_LOCK();
     r_cons_push ();
 
     // r_cmd_call does not return the output of the command
     r_cmd_call(core->rcmd, cmd);
+    if (!isReadOnlyCommand(cmd)) {
+        bumpAnalysisGeneration();
+    }
 
     // we grab the output straight from r_cons
     res = r_cons_get_buffer();
+    profile.setOutputSize(res.size());
 
     // cleaning up
     r_cons_pop ();
@@ -470,43 +829,144 @@ QString IaitoCore::cmdRaw(const char *cmd)
 
 QJsonDocument IaitoCore::cmdj(const char *str)
 {
+    CommandProfiler::Scope profile(str);
     char *res;
     {
         CORE_LOCK();
         res = r_core_cmd_str(core, str);
+        if (!isReadOnlyCommand(str)) {
+            bumpAnalysisGeneration();
+        }
     }
+    profile.setOutputSize(res ? static_cast<qint64>(strlen(res)) : 0);
 
+    profile.beginParse();
     QJsonDocument doc = parseJson(res, str);
+    profile.endParse();
     r_mem_free(res);
 
     return doc;
 }
 
+bool IaitoCore::cmdjForEach(const char *str, const std::function<bool(const QJsonValue &)> &callback)
+{
+    CommandProfiler::Scope profile(str);
+    char *res;
+    {
+        CORE_LOCK();
+        res = r_core_cmd_str(core, str);
+        if (!isReadOnlyCommand(str)) {
+            bumpAnalysisGeneration();
+        }
+    }
+    profile.setOutputSize(res ? static_cast<qint64>(strlen(res)) : 0);
+
+    bool ok = true;
+    if (res && *res) {
+        profile.beginParse();
+        ok = JsonStream::forEachArrayElement(res, strlen(res), [&](const char *begin, const char *end) {
+            return callback(JsonStream::parseValue(begin, end));
+        });
+        profile.endParse();
+        if (!ok) {
+            eprintf("Failed to parse JSON array for command \"%s\"\n", str);
+        }
+    }
+    r_mem_free(res);
+
+    return ok;
+}
+
+bool IaitoCore::cmdjForEachObject(const char *str, const std::function<bool(const JsonStreamObject &)> &callback)
+{
+    CommandProfiler::Scope profile(str);
+    char *res;
+    {
+        CORE_LOCK();
+        res = r_core_cmd_str(core, str);
+        if (!isReadOnlyCommand(str)) {
+            bumpAnalysisGeneration();
+        }
+    }
+    profile.setOutputSize(res ? static_cast<qint64>(strlen(res)) : 0);
+
+    profile.beginParse();
+    bool ok = forEachJsonObject(res, str, callback);
+    profile.endParse();
+    r_mem_free(res);
+
+    return ok;
+}
+
+bool IaitoCore::forEachJsonObject(const char *res, const char *cmd,
+                                  const std::function<bool(const JsonStreamObject &)> &callback)
+{
+    if (!res || !*res) {
+        return true;
+    }
+
+    bool ok = JsonStream::forEachArrayElement(res, strlen(res), [&](const char *begin, const char *end) {
+        JsonStreamObject object(begin, end);
+        if (!object.isValid()) {
+            return false;
+        }
+        return callback(object);
+    });
+    if (!ok) {
+        eprintf("Failed to parse JSON array for command \"%s\"\n", cmd);
+    }
+    return ok;
+}
+
 QJsonDocument IaitoCore::cmdjAt(const char *str, RVA address)
 {
-    QJsonDocument res;
-    RVA oldOffset = getOffset();
-    seekSilent(address);
+    CommandProfiler::Scope profile(str);
+    char *res;
+    {
+        CORE_LOCK();
+        TempOffset tempOffset(core, address, isWriteCommand(str));
+        res = r_core_cmd_str(core, str);
+        if (!isReadOnlyCommand(str)) {
+            bumpAnalysisGeneration();
+        }
+    }
+    profile.setOutputSize(res ? static_cast<qint64>(strlen(res)) : 0);
 
-    res = cmdj(str);
+    profile.beginParse();
+    QJsonDocument doc = parseJson(res, str);
+    profile.endParse();
+    r_mem_free(res);
 
-    seekSilent(oldOffset);
-    return res;
+    return doc;
 }
 
-QString IaitoCore::cmdTask(const QString &str)
+static void runR2Task(R2Task &task, AsyncTask *owner)
 {
-    R2Task task(str);
+    // How long an interrupted command may run before it is broken again
+    const int breakPollMs = 50;
+
     task.startTask();
+    if (owner) {
+        while (!task.waitFinished(breakPollMs)) {
+            if (owner->isInterrupted()) {
+                task.breakTask();
+            }
+        }
+    }
     task.joinTask();
+}
+
+QString IaitoCore::cmdTask(const QString &str, AsyncTask *owner)
+{
+    R2Task task(str);
+    runR2Task(task, owner);
     return task.getResult();
 }
 
-QJsonDocument IaitoCore::cmdjTask(const QString &str)
+QJsonDocument IaitoCore::cmdjTask(const QString &str, AsyncTask *owner)
 {
     R2Task task(str);
-    task.startTask();
-    task.joinTask();
+    runR2Task(task, owner);
     return parseJson(task.getResultRaw(), str);
 }
 
@@ -627,6 +1087,7 @@ bool IaitoCore::loadFile(QString path, ut64 baddr, ut64 mapaddr, int perms, int
         r_core_cmd0 (core, "omfg+w");
     }
 
+    bumpAnalysisGeneration();
     fflush(stdout);
     return true;
 }
@@ -663,6 +1124,7 @@ bool IaitoCore::mapFile(QString path, RVA mapaddr)
     } else {
         return false;
     }
+    bumpAnalysisGeneration();
     return true;
 }
 
@@ -836,7 +1298,7 @@ void IaitoCore::delComment(RVA addr)
  */
 QString IaitoCore::getCommentAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return r_meta_get_string(core->anal, R_META_TYPE_COMMENT, addr);
 }
 
@@ -937,17 +1399,25 @@ void IaitoCore::updateSeek()
 RVA IaitoCore::prevOpAddr(RVA startAddr, int count)
 {
     CORE_LOCK();
+    RVA offset = stepInstructions(startAddr, -count);
+    if (offset != RVA_INVALID) {
+        return offset;
+    }
+
     bool ok;
-    RVA offset = cmdRawAt(QString("/O %1").arg(count), startAddr).toULongLong(&ok, 16);
+    offset = cmdRawAt(QString("/O %1").arg(count), startAddr).toULongLong(&ok, 16);
     return ok ? offset : startAddr - count;
 }
 
 RVA IaitoCore::nextOpAddr(RVA startAddr, int count)
 {
     CORE_LOCK();
+    RVA offset = stepInstructions(startAddr, count);
+    if (offset != RVA_INVALID) {
+        return offset;
+    }
 
-    QJsonArray array = Core()->cmdj("pdj " + QString::number(count + 1) + "@" + QString::number(
-                                        startAddr)).array();
+    QJsonArray array = cmdjAt(QString("pdj %1").arg(count + 1).toUtf8().constData(), startAddr).array();
     if (array.isEmpty()) {
         return startAddr + 1;
     }
@@ -958,7 +1428,7 @@ RVA IaitoCore::nextOpAddr(RVA startAddr, int count)
     }
 
     bool ok;
-    RVA offset = instValue.toObject()[RJsonKey::offset].toVariant().toULongLong(&ok);
+    offset = instValue.toObject()[RJsonKey::offset].toVariant().toULongLong(&ok);
     if (!ok) {
         return startAddr + 1;
     }
@@ -966,6 +1436,166 @@ RVA IaitoCore::nextOpAddr(RVA startAddr, int count)
     return offset;
 }
 
+RVA IaitoCore::stepInstructions(RVA addr, int count)
+{
+    if (count == 0) {
+        return addr;
+    }
+    // Writes, asm.* changes and analysis all move the generation
+    const quint64 generation = getAnalysisGeneration();
+    if (generation != instructionIndexGeneration) {
+        instructionIndex.clear();
+        indexedFunctions.clear();
+        instructionIndexGeneration = generation;
+    }
+
+    RVA result = instructionIndex.step(addr, count);
+    if (result != RVA_INVALID) {
+        return result;
+    }
+
+    RAnalFunction *fcn = r_anal_get_fcn_in(core_->anal, addr, 0);
+    if (fcn && !indexedFunctions.contains(fcn->addr)) {
+        indexFunctionInstructions(fcn);
+        result = instructionIndex.step(addr, count);
+        if (result != RVA_INVALID) {
+            return result;
+        }
+    }
+
+    // Outside of the function or not analyzed at all, decode from the edge of what is known
+    int maxOpSize = r_anal_archinfo(core_->anal, R_ANAL_ARCHINFO_MAX_OP_SIZE);
+    if (maxOpSize <= 0) {
+        maxOpSize = 16;
+    }
+    if (count > 0) {
+        RVA from = addr;
+        int known = 0;
+        const RVA runStart = instructionIndex.runStart(addr);
+        if (runStart != RVA_INVALID && instructionIndex.isBoundary(addr)) {
+            // Continue after the last instruction of the run
+            while (known < count && instructionIndex.step(addr, known + 1) != RVA_INVALID) {
+                known++;
+            }
+            from = instructionIndex.step(addr, known);
+        }
+        instructionIndex.insert(decodeInstructions(from, RVA_INVALID, count - known + 1));
+    } else {
+        // Backwards there is no way to tell where instructions start, try the
+        // alignments before the furthest one that may lead to addr
+        const RVA distance = static_cast<RVA>(-count) * maxOpSize;
+        const RVA from = addr > distance ? addr - distance : 0;
+        int align = r_anal_archinfo(core_->anal, R_ANAL_ARCHINFO_ALIGN);
+        if (align <= 0) {
+            align = 1;
+        }
+        for (RVA start = from - from % align; start < from + maxOpSize && start < addr; start += align) {
+            InstructionIndex::Run run = decodeInstructions(start, addr, -count * maxOpSize);
+            if (run.starts.size() >= -count) {
+                instructionIndex.insert(run);
+                break;
+            }
+        }
+    }
+    return instructionIndex.step(addr, count);
+}
+
+void IaitoCore::indexFunctionInstructions(RAnalFunction *fcn)
+{
+    indexedFunctions.append(fcn->addr);
+
+    // (start, end) of every instruction of every basic block
+    QVector<QPair<RVA, RVA>> instructions;
+    RListIter *iter;
+    RAnalBlock *bb;
+    IaitoRListForeach(fcn->bbs, iter, RAnalBlock, bb) {
+        for (int i = 0; i < bb->ninstr; i++) {
+            const RVA start = bb->addr + r_anal_bb_offset_inst(bb, i);
+            const RVA end = i + 1 < bb->ninstr
+                            ? bb->addr + r_anal_bb_offset_inst(bb, i + 1)
+                            : bb->addr + bb->size;
+            instructions.append({ start, end });
+        }
+    }
+    std::sort(instructions.begin(), instructions.end());
+
+    // Blocks are split into runs wherever there is a gap between them
+    InstructionIndex::Run run;
+    for (const auto &instruction : instructions) {
+        if (!run.starts.isEmpty() && instruction.first == run.starts.last()) {
+            continue;
+        }
+        if (!run.starts.isEmpty() && instruction.first != run.end) {
+            instructionIndex.insert(run);
+            run = InstructionIndex::Run();
+        }
+        run.starts.append(instruction.first);
+        run.end = instruction.second;
+    }
+    instructionIndex.insert(run);
+}
+
+InstructionIndex::Run IaitoCore::decodeInstructions(RVA from, RVA until, int count)
+{
+    InstructionIndex::Run run;
+    int maxOpSize = r_anal_archinfo(core_->anal, R_ANAL_ARCHINFO_MAX_OP_SIZE);
+    if (maxOpSize <= 0) {
+        maxOpSize = 16;
+    }
+    int minOpSize = r_anal_archinfo(core_->anal, R_ANAL_ARCHINFO_MIN_OP_SIZE);
+    if (minOpSize <= 0) {
+        minOpSize = 1;
+    }
+
+    const RVA bufSize = until != RVA_INVALID ? until - from + maxOpSize : static_cast<RVA>(count) * maxOpSize;
+    if (bufSize > 1024 * 1024) {
+        return run;
+    }
+    QByteArray buf(static_cast<int>(bufSize), '\xff');
+    r_io_read_at(core_->io, from, reinterpret_cast<ut8 *>(buf.data()), buf.size());
+
+    RVA pc = from;
+    int pos = 0;
+    RAsmOp op;
+    while (run.starts.size() < count && pos < buf.size() && (until == RVA_INVALID || pc < until)) {
+        r_asm_op_init(&op);
+        r_asm_set_pc(core_->rasm, pc);
+        int size = r_asm_disassemble(core_->rasm, &op,
+                                     reinterpret_cast<const ut8 *>(buf.constData()) + pos, buf.size() - pos);
+        r_asm_op_fini(&op);
+        // Same as pd, which honors "ahs" size hints and shows invalid bytes one by one
+        RAnalHint *hint = r_anal_hint_get(core_->anal, pc);
+        if (hint) {
+            if (hint->size) {
+                size = hint->size;
+            }
+            r_anal_hint_free(hint);
+        }
+        // Data and strings are skipped as a whole
+        ut64 metaSize = 0;
+        RAnalMetaItem *meta = r_meta_get_at(core_->anal, pc, R_META_TYPE_ANY, &metaSize);
+        if (meta && metaSize && (meta->type == R_META_TYPE_DATA || meta->type == R_META_TYPE_STRING
+                                 || meta->type == R_META_TYPE_FORMAT)) {
+            size = static_cast<int>(metaSize);
+        }
+        if (size <= 0) {
+            size = minOpSize;
+        }
+        run.starts.append(pc);
+        if (pc + size < pc) {
+            break;
+        }
+        pc += size;
+        pos += size;
+    }
+    run.end = pc;
+
+    if (until != RVA_INVALID && pc != until) {
+        return InstructionIndex::Run();
+    }
+    return run;
+}
+
 RVA IaitoCore::getOffset()
 {
     return core_->offset;
@@ -988,57 +1618,100 @@ QString IaitoCore::itoa(ut64 num, int rdx)
     return QString::number(num, rdx);
 }
 
+static thread_local int threadTempConfigDepth = 0;
+// Only the asm.* keys that change decoding: display ones such as asm.lines are set
+// temporarily on every disassembly refresh and would flush all caches each time
+static const QSet<QString> TEMP_CONFIG_DECODING_KEYS = {
+    "asm.arch", "asm.bits", "asm.cpu", "asm.os",
+};
+// Set when the active TempConfig touched a key that changes what is read or decoded
+static thread_local bool threadTempConfigDirty = false;
+
+void IaitoCore::beginTempConfig()
+{
+    threadTempConfigDepth++;
+    tempConfigCount++;
+}
+
+void IaitoCore::endTempConfig()
+{
+    threadTempConfigDepth--;
+    tempConfigCount--;
+    // Results cached by other threads while the temporary values were active are keyed
+    // on a generation that does not tell them apart, so drop them once restored
+    if (!threadTempConfigDepth && threadTempConfigDirty) {
+        threadTempConfigDirty = false;
+        bumpAnalysisGeneration();
+    }
+}
+
+void IaitoCore::configChanged(const char *k)
+{
+    if (!threadTempConfigDepth) {
+        bumpAnalysisGeneration();
+    } else if (r_str_startswith(k, "io.") || r_str_startswith(k, "cfg.")
+               || TEMP_CONFIG_DECODING_KEYS.contains(QLatin1String(k))) {
+        threadTempConfigDirty = true;
+    }
+}
+
 void IaitoCore::setConfig(const char *k, const char *v)
 {
     CORE_LOCK();
     r_config_set(core->config, k, v);
+    configChanged(k);
 }
 
 void IaitoCore::setConfig(const QString &k, const char *v)
 {
     CORE_LOCK();
-    r_config_set(core->config, k.toUtf8().constData(), v);
+    const QByteArray key = k.toUtf8();
+    r_config_set(core->config, key.constData(), v);
+    configChanged(key.constData());
 }
 
 void IaitoCore::setConfig(const char *k, const QString &v)
 {
     CORE_LOCK();
     r_config_set(core->config, k, v.toUtf8().constData());
+    configChanged(k);
 }
 
 void IaitoCore::setConfig(const char *k, int v)
 {
     CORE_LOCK();
     r_config_set_i(core->config, k, static_cast<ut64>(v));
+    configChanged(k);
 }
 
 void IaitoCore::setConfig(const char *k, bool v)
 {
     CORE_LOCK();
     r_config_set_i(core->config, k, v ? 1 : 0);
+    configChanged(k);
 }
 
 int IaitoCore::getConfigi(const char *k)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return static_cast<int>(r_config_get_i(core->config, k));
 }
 
 ut64 IaitoCore::getConfigut64(const char *k)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return r_config_get_i(core->config, k);
 }
 
 bool IaitoCore::getConfigb(const char *k)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return r_config_get_i(core->config, k) != 0;
 }
 
 QString IaitoCore::getConfigDescription(const char *k)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RConfigNode *node = r_config_node_get (core->config, k);
     return node ? QString(node->desc) : QString("Unrecognized configuration key");
 }
@@ -1072,7 +1745,7 @@ void IaitoCore::message(const QString &msg, bool debug)
 
 QString IaitoCore::getConfig(const char *k)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return QString(r_config_get(core->config, k));
 }
 
@@ -1138,7 +1811,7 @@ QString IaitoCore::disassembleSingleInstruction(RVA addr)
 
 RAnalFunction *IaitoCore::functionIn(ut64 addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RList *fcns = r_anal_get_functions_in (core->anal, addr);
     RAnalFunction *fcn = !r_list_empty(fcns) ? reinterpret_cast<RAnalFunction *>(r_list_first(fcns)) : nullptr;
     r_list_free(fcns);
@@ -1147,7 +1820,7 @@ RAnalFunction *IaitoCore::functionIn(ut64 addr)
 
 RAnalFunction *IaitoCore::functionAt(ut64 addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return r_anal_get_function_at(core->anal, addr);
 }
 
@@ -1158,7 +1831,7 @@ RAnalFunction *IaitoCore::functionAt(ut64 addr)
  */
 RVA IaitoCore::getFunctionStart(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RAnalFunction *fcn = Core()->functionIn(addr);
     return fcn ? fcn->addr : RVA_INVALID;
 }
@@ -1170,7 +1843,7 @@ RVA IaitoCore::getFunctionStart(RVA addr)
  */
 RVA IaitoCore::getFunctionEnd(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RAnalFunction *fcn = Core()->functionIn(addr);
     return fcn ? fcn->addr : RVA_INVALID;
 }
@@ -1182,7 +1855,7 @@ RVA IaitoCore::getFunctionEnd(RVA addr)
  */
 RVA IaitoCore::getLastFunctionInstruction(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RAnalFunction *fcn = Core()->functionIn(addr);
     if (!fcn) {
         return RVA_INVALID;
@@ -1298,40 +1971,45 @@ static inline const QString appendVar(QString &dst, const QString val, const QSt
     return val;
 }
 
-RefDescription IaitoCore::formatRefDesc(QJsonObject refItem)
+RefDescription IaitoCore::formatRefDesc(const AddrRefChain &refs, int first)
 {
     RefDescription desc;
 
     // Ignore empty refs and refs that only contain addr
-    if (refItem.size() <= 1) {
+    if (first < 0 || first >= refs.size()) {
+        return desc;
+    }
+    const AddrRefDescription &head = refs[first];
+    if (head.mapName.isEmpty() && head.section.isEmpty() && head.reg.isEmpty()
+            && head.fcn.isEmpty() && head.type.isEmpty() && head.perms.isEmpty()
+            && head.asmText.isEmpty() && head.string.isEmpty() && !head.hasValue) {
         return desc;
     }
 
-    QString str = refItem["string"].toVariant().toString();
-    if (!str.isEmpty()) {
-        desc.ref = str;
+    if (!head.string.isEmpty()) {
+        desc.ref = head.string;
         desc.refColor = ConfigColor("comment");
     } else {
         QString type, string;
-        do {
+        for (int i = first; i < refs.size(); i++) {
+            const AddrRefDescription &refItem = refs[i];
             desc.ref += " ->";
-            appendVar(desc.ref, refItem["reg"].toVariant().toString(), " @", "");
-            appendVar(desc.ref, refItem["mapname"].toVariant().toString(), " (", ")");
-            appendVar(desc.ref, refItem["section"].toVariant().toString(), " (", ")");
-            appendVar(desc.ref, refItem["func"].toVariant().toString(), " ", "");
-            type = appendVar(desc.ref, refItem["type"].toVariant().toString(), " ", "");
-            appendVar(desc.ref, refItem["perms"].toVariant().toString(), " ", "");
-            appendVar(desc.ref, refItem["asm"].toVariant().toString(), " \"", "\"");
-            string = appendVar(desc.ref, refItem["string"].toVariant().toString(), " ", "");
-            if (!string.isNull()) {
+            appendVar(desc.ref, refItem.reg, " @", "");
+            appendVar(desc.ref, refItem.mapName, " (", ")");
+            appendVar(desc.ref, refItem.section, " (", ")");
+            appendVar(desc.ref, refItem.fcn, " ", "");
+            type = appendVar(desc.ref, refItem.type, " ", "");
+            appendVar(desc.ref, refItem.perms, " ", "");
+            appendVar(desc.ref, refItem.asmText, " \"", "\"");
+            string = appendVar(desc.ref, refItem.string, " ", "");
+            if (!string.isEmpty()) {
                 // There is no point in adding ascii and addr info after a string
                 break;
             }
-            if (!refItem["value"].isNull()) {
-                appendVar(desc.ref, RAddressString(refItem["value"].toVariant().toULongLong()), " ", "");
+            if (refItem.hasValue) {
+                appendVar(desc.ref, RAddressString(refItem.value), " ", "");
             }
-            refItem = refItem["ref"].toObject();
-        } while (!refItem.empty());
+        }
 
         // Set the ref's color according to the last item type
         if (type == "ascii" || !string.isEmpty()) {
@@ -1348,76 +2026,203 @@ RefDescription IaitoCore::formatRefDesc(QJsonObject refItem)
     return desc;
 }
 
-QList<QJsonObject> IaitoCore::getRegisterRefs(int depth)
+QVector<RegisterRefChain> IaitoCore::getRegisterRefs(int depth)
 {
-    QList<QJsonObject> ret;
+    QVector<RegisterRefChain> ret;
     if (!currentlyDebugging) {
         return ret;
     }
 
+    CORE_LOCK();
     QJsonObject registers = cmdj("drj").object();
 
-    for (const QString &key : registers.keys()) {
-        QJsonObject reg;
-        reg["value"] = registers.value(key);
-        reg["ref"] = getAddrRefs(registers.value(key).toVariant().toULongLong(), depth);
-        reg["name"] = key;
+    const QStringList keys = registers.keys();
+    QVector<RVA> values;
+    values.reserve(keys.size());
+    for (const QString &key : keys) {
+        values.append(registers.value(key).toVariant().toULongLong());
+    }
+
+    // Resolve every register together, they often point close to each other
+    const QVector<AddrRefChain> chains = getAddrRefs(values, depth);
+    ret.reserve(keys.size());
+    for (int i = 0; i < keys.size(); i++) {
+        RegisterRefChain reg;
+        reg.name = keys[i];
+        reg.value = values[i];
+        reg.refs = chains[i];
         ret.append(reg);
     }
 
     return ret;
 }
 
-QList<QJsonObject> IaitoCore::getStack(int size, int depth)
+QVector<AddrRefChain> IaitoCore::getStack(int size, int depth)
+{
+    QVector<AddrRefChain> stack;
+    if (!currentlyDebugging) {
+        return stack;
+    }
+
+    CORE_LOCK();
+    // Not "dr SP", which is no read-only command and would invalidate every cached query
+    RVA addr = getRegisterValue("SP");
+    if (addr == RVA_INVALID) {
+        return stack;
+    }
+
+    int base = core->anal->bits;
+    QVector<RVA> slots;
+    for (int i = 0; i < size; i += base / 8) {
+        if ((base == 32 && addr + i >= UT32_MAX) || (base == 16 && addr + i >= UT16_MAX)) {
+            break;
+        }
+        slots.append(addr + i);
+    }
+
+    // The slots are adjacent, so the whole window is read at once
+    return getAddrRefs(slots, depth);
+}
+
+QVector<AddrRefChain> IaitoCore::getAddrRefs(const QVector<RVA> &addrs, int depth)
 {
-    QList<QJsonObject> stack;
-    if (!currentlyDebugging) {
-        return stack;
+    QVector<AddrRefChain> chains(addrs.size());
+    if (depth < 1) {
+        return chains;
     }
 
     CORE_LOCK();
-    bool ret;
-    RVA addr = cmdRaw("dr SP").toULongLong(&ret, 16);
-    if (!ret) {
-        return stack;
-    }
-
-    int base = core->anal->bits;
-    for (int i = 0; i < size; i += base / 8) {
-        if ((base == 32 && addr + i >= UT32_MAX) || (base == 16 && addr + i >= UT16_MAX)) {
+    const quint64 generation = getAnalysisGeneration();
+    if (generation != telescopeMemoGeneration || telescopeMemo.size() > 100000) {
+        telescopeMemo.clear();
+        telescopeMemoGeneration = generation;
+    }
+
+    // Next address to resolve for every chain that is still growing
+    QVector<RVA> next = addrs;
+    for (int level = 0; level < depth; level++) {
+        QVector<RVA> pending;
+        for (RVA addr : next) {
+            if (addr != UT64_MAX) {
+                pending.append(addr);
+            }
+        }
+        if (pending.isEmpty()) {
             break;
         }
+        resolveTelescopeEntries(pending);
 
-        stack.append(getAddrRefs(addr + i, depth));
+        for (int i = 0; i < chains.size(); i++) {
+            const RVA addr = next[i];
+            next[i] = UT64_MAX;
+            if (addr == UT64_MAX) {
+                continue;
+            }
+            AddrRefChain &chain = chains[i];
+            const TelescopeEntry &entry = telescopeMemo[addr];
+            if (level > 0) {
+                // Only follow pointers to something known
+                if (entry.desc.type.isEmpty()) {
+                    continue;
+                }
+                // If the dereference of the last pointer is an ascii character we
+                // might have a string in its address
+                if (entry.desc.type.contains("ascii")) {
+                    const TelescopeEntry &prev = telescopeMemo[chain.last().addr];
+                    QString strVal = QString(prev.bytes);
+                    // Indicate that the string is longer than the printed value
+                    if (strVal.size() == prev.bytes.size()) {
+                        strVal += "...";
+                    }
+                    chain.last().string = strVal;
+                }
+            }
+            chain.append(entry.desc);
+            // Make sure we aren't telescoping the same address
+            if (entry.desc.hasValue && entry.desc.value != addr) {
+                next[i] = entry.desc.value;
+            }
+        }
     }
 
-    return stack;
+    return chains;
 }
 
-QJsonObject IaitoCore::getAddrRefs(RVA addr, int depth) {
-    QJsonObject json;
-    if (depth < 1 || addr == UT64_MAX) {
-        return json;
+void IaitoCore::resolveTelescopeEntries(QVector<RVA> addrs)
+{
+    // Enough for the disassembly, the pointer and the string at an address
+    const int entrySize = 128;
+    // Neighbours closer than this are read together with a single io request
+    const RVA maxGap = 0x200;
+    const RVA maxSpan = 0x10000;
+
+    std::sort(addrs.begin(), addrs.end());
+    addrs.erase(std::unique(addrs.begin(), addrs.end()), addrs.end());
+
+    QVector<RVA> toRead;
+    QHash<RVA, ut64> types;
+    for (RVA addr : addrs) {
+        if (telescopeMemo.contains(addr)) {
+            continue;
+        }
+        ut64 type = r_core_anal_address(core, addr);
+        types.insert(addr, type);
+        if (type & (R_ANAL_ADDR_TYPE_READ | R_ANAL_ADDR_TYPE_EXEC)) {
+            toRead.append(addr);
+        }
     }
 
-    CORE_LOCK();
-    int bits = core->rasm->bits;
-    QByteArray buf = QByteArray();
-    ut64 type = r_core_anal_address(core, addr);
+    QHash<RVA, QByteArray> bytes;
+    for (int groupStart = 0; groupStart < toRead.size();) {
+        int groupEnd = groupStart + 1;
+        while (groupEnd < toRead.size()
+                && toRead[groupEnd] - toRead[groupEnd - 1] <= maxGap
+                && toRead[groupEnd] - toRead[groupStart] <= maxSpan
+                && toRead[groupEnd] <= UT64_MAX - entrySize) {
+            groupEnd++;
+        }
+        const RVA base = toRead[groupStart];
+        QByteArray buf(static_cast<int>(toRead[groupEnd - 1] - base) + entrySize, '\xff');
+        if (r_io_read_at(core->io, base, (unsigned char *)buf.data(), buf.size())) {
+            for (int i = groupStart; i < groupEnd; i++) {
+                bytes.insert(toRead[i], buf.mid(static_cast<int>(toRead[i] - base), entrySize));
+            }
+        } else {
+            // Part of the range may be unmapped, fall back to reading every address on its own
+            for (int i = groupStart; i < groupEnd; i++) {
+                QByteArray single(entrySize, '\xff');
+                r_io_read_at(core->io, toRead[i], (unsigned char *)single.data(), single.size());
+                bytes.insert(toRead[i], single);
+            }
+        }
+        groupStart = groupEnd;
+    }
+
+    for (auto it = types.constBegin(); it != types.constEnd(); ++it) {
+        telescopeMemo.insert(it.key(), makeTelescopeEntry(it.key(), it.value(),
+                                                          bytes.value(it.key())));
+    }
+}
 
-    json["addr"] = QString::number(addr);
+IaitoCore::TelescopeEntry IaitoCore::makeTelescopeEntry(RVA addr, ut64 type,
+                                                        const QByteArray &bytes)
+{
+    TelescopeEntry entry;
+    entry.bytes = bytes;
+    AddrRefDescription &desc = entry.desc;
+    desc.addr = addr;
 
     // Search for the section the addr is in, avoid duplication for heap/stack with type
     if(!(type & R_ANAL_ADDR_TYPE_HEAP || type & R_ANAL_ADDR_TYPE_STACK)) {
         // Attempt to find the address within a map
         RDebugMap *map = r_debug_map_get(core->dbg, addr);
         if (map && map->name && map->name[0]) {
-            json["mapname"] = map->name;
+            desc.mapName = map->name;
         }
 
         RBinSection *sect = r_bin_get_section_at(r_bin_cur_object (core->bin), addr, true);
         if (sect && sect->name[0]) {
-            json["section"] = sect->name;
+            desc.section = sect->name;
         }
     }
 
@@ -1426,86 +2231,64 @@ QJsonObject IaitoCore::getAddrRefs(RVA addr, int depth) {
     if (fi) {
         RRegItem *r = r_reg_get(core->dbg->reg, fi->name, -1);
         if (r) {
-            json["reg"] = r->name;
+            desc.reg = r->name;
         }
     }
 
     // Attempt to find the address within a function
     RAnalFunction *fcn = r_anal_get_fcn_in(core->anal, addr, 0);
     if (fcn) {
-        json["fcn"] = fcn->name;
+        desc.fcn = fcn->name;
     }
 
     // Update type and permission information
     if (type != 0) {
         if (type & R_ANAL_ADDR_TYPE_HEAP) {
-            json["type"] = "heap";
+            desc.type = "heap";
         } else if (type & R_ANAL_ADDR_TYPE_STACK) {
-            json["type"] = "stack";
+            desc.type = "stack";
         } else if (type & R_ANAL_ADDR_TYPE_PROGRAM) {
-            json["type"] = "program";
+            desc.type = "program";
         } else if (type & R_ANAL_ADDR_TYPE_LIBRARY) {
-            json["type"] = "library";
+            desc.type = "library";
         } else if (type & R_ANAL_ADDR_TYPE_ASCII) {
-            json["type"] = "ascii";
+            desc.type = "ascii";
         } else if (type & R_ANAL_ADDR_TYPE_SEQUENCE) {
-            json["type"] = "sequence";
+            desc.type = "sequence";
         }
 
-        QString perms = "";
         if (type & R_ANAL_ADDR_TYPE_READ) {
-            perms += "r";
+            desc.perms += "r";
         }
         if (type & R_ANAL_ADDR_TYPE_WRITE) {
-            perms += "w";
+            desc.perms += "w";
         }
         if (type & R_ANAL_ADDR_TYPE_EXEC) {
             RAsmOp op;
-            buf.resize(32);
-            perms += "x";
+            desc.perms += "x";
             // Instruction disassembly
-            r_io_read_at(core->io, addr, (unsigned char*)buf.data(), buf.size());
             r_asm_set_pc(core->rasm, addr);
-            r_asm_disassemble(core->rasm, &op, (unsigned char*)buf.data(), buf.size());
-            json["asm"] = r_asm_op_get_asm(&op);
-        }
-
-        if (!perms.isEmpty()) {
-            json["perms"] = perms;
+            r_asm_disassemble(core->rasm, &op, (const unsigned char *)bytes.constData(), 32);
+            desc.asmText = r_asm_op_get_asm(&op);
         }
     }
 
-    // Try to telescope further if depth permits it
+    // The value of the next address will serve as an indication that there's more to
+    // telescope if we have reached the depth limit
     if ((type & R_ANAL_ADDR_TYPE_READ) && !(type & R_ANAL_ADDR_TYPE_EXEC)) {
-        buf.resize(64);
-        ut32 *n32 = (ut32 *)buf.data();
-        ut64 *n64 = (ut64 *)buf.data();
-        r_io_read_at(core->io, addr, (unsigned char*)buf.data(), buf.size());
-        ut64 n = (bits == 64)? *n64: *n32;
-        // The value of the next address will serve as an indication that there's more to
-        // telescope if we have reached the depth limit
-        json["value"] = QString::number(n);
-        if (depth && n != addr) {
-            // Make sure we aren't telescoping the same address
-            QJsonObject ref = getAddrRefs(n, depth - 1);
-            if (!ref.empty() && !ref["type"].isNull()) {
-                // If the dereference of the current pointer is an ascii character we
-                // might have a string in this address
-                if (ref["type"].toString().contains("ascii")) {
-                    buf.resize(128);
-                    r_io_read_at(core->io, addr, (unsigned char*)buf.data(), buf.size());
-                    QString strVal = QString(buf);
-                    // Indicate that the string is longer than the printed value
-                    if (strVal.size() == buf.size()) {
-                        strVal += "...";
-                    }
-                    json["string"] = strVal;
-                }
-                json["ref"] = ref;
-            }
+        if (core->rasm->bits == 64) {
+            ut64 n64;
+            memcpy(&n64, bytes.constData(), sizeof(n64));
+            desc.value = n64;
+        } else {
+            ut32 n32;
+            memcpy(&n32, bytes.constData(), sizeof(n32));
+            desc.value = n32;
         }
+        desc.hasValue = true;
     }
-    return json;
+
+    return entry;
 }
 
 QJsonDocument IaitoCore::getProcessThreads(int pid)
@@ -1581,18 +2364,24 @@ QString IaitoCore::getRegisterName(QString registerRole)
 
 RVA IaitoCore::getProgramCounterValue()
 {
-    bool ok;
     if (currentlyDebugging) {
-        // Use cmd because cmdRaw would not work with inner command backticked
-        // TODO: Risky command due to changes in API, search for something safer
-        RVA addr = cmd("dr `drn PC`").toULongLong(&ok, 16);
-        if (ok) {
-            return addr;
-        }
+        return getRegisterValue("PC");
     }
     return RVA_INVALID;
 }
 
+RVA IaitoCore::getRegisterValue(const char *name)
+{
+    CORE_LOCK();
+    RReg *reg = core->anal->reg;
+    if (r_config_get_i(core->config, "cfg.debug")) {
+        r_debug_reg_sync(core->dbg, R_REG_TYPE_GPR, false);
+        reg = core->dbg->reg;
+    }
+    RRegItem *item = r_reg_get(reg, name, -1);
+    return item ? r_reg_get_value(reg, item) : RVA_INVALID;
+}
+
 void IaitoCore::setRegister(QString regName, QString regValue)
 {
     cmdRaw(QString("dr %1=%2").arg(regName).arg(regValue));
@@ -2207,13 +2996,13 @@ static BreakpointDescription breakpointDescriptionFromR2(int index, r_bp_item_t
 
 int IaitoCore::breakpointIndexAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     return r_bp_get_index_at(core->dbg->bp, addr);
 }
 
 BreakpointDescription IaitoCore::getBreakpointAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     int index = breakpointIndexAt(addr);
     auto bp = r_bp_get_index(core->dbg->bp, index);
     if (bp) {
@@ -2224,7 +3013,7 @@ BreakpointDescription IaitoCore::getBreakpointAt(RVA addr)
 
 QList<BreakpointDescription> IaitoCore::getBreakpoints()
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<BreakpointDescription> ret;
     //TODO: use higher level API, don't touch r2 bps_idx directly
     for (int i = 0; i < core->dbg->bp->bps_idx_count; i++) {
@@ -2239,12 +3028,14 @@ QList<BreakpointDescription> IaitoCore::getBreakpoints()
 
 QList<RVA> IaitoCore::getBreakpointsAddresses()
 {
-    QList<RVA> bpAddresses;
-    for (const BreakpointDescription &bp : getBreakpoints()) {
-        bpAddresses << bp.addr;
-    }
+    return cachedQuery<QList<RVA>>(QStringLiteral("getBreakpointsAddresses"), [this]() -> QList<RVA> {
+        QList<RVA> bpAddresses;
+        for (const BreakpointDescription &bp : getBreakpoints()) {
+            bpAddresses << bp.addr;
+        }
 
-    return bpAddresses;
+        return bpAddresses;
+    });
 }
 
 QList<RVA> IaitoCore::getBreakpointsInFunction(RVA funcAddr)
@@ -2316,27 +3107,36 @@ QList<MemoryMapDescription> IaitoCore::getMemoryMap()
 
 QStringList IaitoCore::getStats()
 {
-    QStringList stats;
-    cmdRaw("fs functions");
-
-    // The cmd coomand is frequently used in this function because
-    // cmdRaw would not work with grep
-    stats << cmd("f~?").trimmed();
-
-    QString imps = cmd("ii~?").trimmed();
-    stats << imps;
-
-    cmdRaw("fs symbols");
-    stats << cmd("f~?").trimmed();
-    cmdRaw("fs strings");
-    stats << cmd("f~?").trimmed();
-    cmdRaw("fs relocs");
-    stats << cmd("f~?").trimmed();
-    cmdRaw("fs sections");
-    stats << cmd("f~?").trimmed();
-    cmdRaw("fs *");
-    stats << cmd("f~?").trimmed();
+    CORE_LOCK_SHARED();
+    // Counted natively, "fs <space>; f~?" would switch the global flagspace
+    // and bump the analysis generation on every refresh
+    auto countFlags = [this](const char *spaceName) -> int {
+        const RSpace *space = nullptr;
+        if (spaceName) {
+            space = r_flag_space_get(core->flags, spaceName);
+            if (!space) {
+                return 0;
+            }
+        }
+        int count = 0;
+        r_flag_foreach_space(core->flags, space, [](RFlagItem *, void *user) -> bool {
+            (*reinterpret_cast<int *>(user))++;
+            return true;
+        }, &count);
+        return count;
+    };
+
+    RBinObject *obj = r_bin_cur_object(core->bin);
+    const int imports = obj && obj->imports ? r_list_length(obj->imports) : 0;
 
+    QStringList stats;
+    stats << QString::number(countFlags("functions"))
+          << QString::number(imports)
+          << QString::number(countFlags("symbols"))
+          << QString::number(countFlags("strings"))
+          << QString::number(countFlags("relocs"))
+          << QString::number(countFlags("sections"))
+          << QString::number(countFlags(nullptr));
     return stats;
 }
 
@@ -2527,35 +3327,78 @@ QList<RAsmPluginDescription> IaitoCore::getRAsmPluginDescriptions()
 
 QList<FunctionDescription> IaitoCore::getAllFunctions()
 {
-    CORE_LOCK();
-
-    QList<FunctionDescription> funcList;
-    funcList.reserve(r_list_length(core->anal->fcns));
+    return cachedQuery<QList<FunctionDescription>>(QStringLiteral("getAllFunctions"), [this]() -> QList<FunctionDescription> {
+        CORE_LOCK_SHARED();
+
+        QList<FunctionDescription> funcList;
+        funcList.reserve(r_list_length(core->anal->fcns));
+
+        RListIter *iter;
+        RAnalFunction *fcn;
+        IaitoRListForeach (core->anal->fcns, iter, RAnalFunction, fcn) {
+            FunctionDescription function;
+            function.offset = fcn->addr;
+            function.linearSize = r_anal_function_linear_size(fcn);
+            function.nargs = r_anal_var_count(core->anal, fcn, 'b', 1) +
+                r_anal_var_count(core->anal, fcn, 'r', 1) +
+                r_anal_var_count(core->anal, fcn, 's', 1);
+            function.nlocals = r_anal_var_count(core->anal, fcn, 'b', 0) +
+                r_anal_var_count(core->anal, fcn, 'r', 0) +
+                r_anal_var_count(core->anal, fcn, 's', 0);
+            function.nbbs = r_list_length (fcn->bbs);
+            function.calltype = fcn->cc ? QString::fromUtf8(fcn->cc) : QString();
+            function.name = fcn->name ? QString::fromUtf8(fcn->name) : QString();
+            function.edges = r_anal_function_count_edges(fcn, nullptr);
+            function.stackframe = fcn->maxstack;
+            funcList.append(function);
+        }
 
-    RListIter *iter;
-    RAnalFunction *fcn;
-    IaitoRListForeach (core->anal->fcns, iter, RAnalFunction, fcn) {
-        FunctionDescription function;
-        function.offset = fcn->addr;
-        function.linearSize = r_anal_function_linear_size(fcn);
-        function.nargs = r_anal_var_count(core->anal, fcn, 'b', 1) +
-            r_anal_var_count(core->anal, fcn, 'r', 1) +
-            r_anal_var_count(core->anal, fcn, 's', 1);
-        function.nlocals = r_anal_var_count(core->anal, fcn, 'b', 0) +
-            r_anal_var_count(core->anal, fcn, 'r', 0) +
-            r_anal_var_count(core->anal, fcn, 's', 0);
-        function.nbbs = r_list_length (fcn->bbs);
-        function.calltype = fcn->cc ? QString::fromUtf8(fcn->cc) : QString();
-        function.name = fcn->name ? QString::fromUtf8(fcn->name) : QString();
-        function.edges = r_anal_function_count_edges(fcn, nullptr);
-        function.stackframe = fcn->maxstack;
-        funcList.append(function);
-    }
-
-    return funcList;
+        return funcList;
+    });
 }
 
 QList<ImportDescription> IaitoCore::getAllImports()
+{
+    return cachedQuery<QList<ImportDescription>>(QStringLiteral("getAllImports"), [this]() -> QList<ImportDescription> {
+        CORE_LOCK();
+        RBinObject *obj = r_bin_cur_object(core->bin);
+        if (!obj) {
+            return getAllImportsJson();
+        }
+
+        // Same lookup as "iij": the plt address is the one of the matching "imp." symbol
+        QHash<QString, RVA> pltAddrs;
+        RListIter *it;
+        RBinSymbol *sym;
+        IaitoRListForeach(obj->symbols, it, RBinSymbol, sym) {
+            if (sym->name && !strncmp(sym->name, "imp.", 4)) {
+                pltAddrs.insert(QString::fromUtf8(sym->name + 4),
+                                r_bin_get_vaddr(core->bin, sym->paddr, sym->vaddr));
+            }
+        }
+
+        QList<ImportDescription> ret;
+        ret.reserve(r_list_length(obj->imports));
+
+        RBinImport *imp;
+        IaitoRListForeach(obj->imports, it, RBinImport, imp) {
+            ImportDescription import;
+
+            import.name = QString::fromUtf8(imp->name);
+            import.plt = pltAddrs.value(import.name, 0);
+            import.ordinal = imp->ordinal;
+            import.bind = QString::fromUtf8(imp->bind);
+            import.type = QString::fromUtf8(imp->type);
+            import.libname = QString::fromUtf8(imp->libname);
+
+            ret << import;
+        }
+
+        return ret;
+    });
+}
+
+QList<ImportDescription> IaitoCore::getAllImportsJson()
 {
     CORE_LOCK();
     QList<ImportDescription> ret;
@@ -2607,7 +3450,7 @@ QList<ExportDescription> IaitoCore::getAllExports()
 
 QList<SymbolDescription> IaitoCore::getAllSymbols()
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     RListIter *it;
 
     QList<SymbolDescription> ret;
@@ -2641,6 +3484,30 @@ QList<SymbolDescription> IaitoCore::getAllSymbols()
 }
 
 QList<HeaderDescription> IaitoCore::getAllHeaders()
+{
+    CORE_LOCK();
+    if (!r_bin_cur_object(core->bin)) {
+        return getAllHeadersJson();
+    }
+
+    QList<HeaderDescription> ret;
+    RListIter *it;
+    RBinField *field;
+    IaitoRListForeach(r_bin_get_fields(core->bin), it, RBinField, field) {
+        HeaderDescription header;
+
+        header.vaddr = r_bin_get_vaddr(core->bin, field->paddr, field->vaddr);
+        header.paddr = field->paddr;
+        header.value = QString::fromUtf8(field->comment);
+        header.name = QString::fromUtf8(field->name);
+
+        ret << header;
+    }
+
+    return ret;
+}
+
+QList<HeaderDescription> IaitoCore::getAllHeadersJson()
 {
     CORE_LOCK();
     QList<HeaderDescription> ret;
@@ -2696,20 +3563,20 @@ QList<ZignatureDescription> IaitoCore::getAllZignatures()
 
 QList<CommentDescription> IaitoCore::getAllComments(const QString &filterType)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<CommentDescription> ret;
 
-    QJsonArray commentsArray = cmdj("CCj").array();
-    for (const QJsonValue value : commentsArray) {
-        QJsonObject commentObject = value.toObject();
-
-        QString type = commentObject[RJsonKey::type].toString();
-        if (type != filterType)
+    RIntervalTreeIter it;
+    RAnalMetaItem *item;
+    r_interval_tree_foreach (&core->anal->meta, it, item) {
+        // filterType uses the same names as the "type" key of "CCj"
+        if (filterType != QLatin1String(r_meta_type_to_string(item->type))) {
             continue;
+        }
 
         CommentDescription comment;
-        comment.offset = commentObject[RJsonKey::offset].toVariant().toULongLong();
-        comment.name = commentObject[RJsonKey::name].toString();
+        comment.offset = r_interval_tree_iter_get(&it)->start;
+        comment.name = QString::fromUtf8(item->str);
 
         ret << comment;
     }
@@ -2718,7 +3585,7 @@ QList<CommentDescription> IaitoCore::getAllComments(const QString &filterType)
 
 QList<RelocDescription> IaitoCore::getAllRelocs()
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<RelocDescription> ret;
 
     if (core && core->bin && core->bin->cur && core->bin->cur->o) {
@@ -2746,45 +3613,47 @@ QList<RelocDescription> IaitoCore::getAllRelocs()
 
 QList<StringDescription> IaitoCore::getAllStrings()
 {
-    return parseStringsJson(cmdjTask("izzj"));
+    CORE_LOCK();
+    bool ok;
+    QList<StringDescription> ret = NativeDescriptions::strings(core, &ok);
+    return ok ? ret : getAllStringsJson();
 }
 
-QList<StringDescription> IaitoCore::parseStringsJson(const QJsonDocument &doc)
+QList<StringDescription> IaitoCore::getAllStringsJson()
 {
     QList<StringDescription> ret;
 
-    QJsonArray stringsArray = doc.array();
-    for (const QJsonValue value : stringsArray) {
-        QJsonObject stringObject = value.toObject();
+    R2Task task("izzj");
+    task.startTask();
+    task.joinTask();
 
+    forEachJsonObject(task.getResultRaw(), "izzj", [&ret](const JsonStreamObject &stringObject) {
         StringDescription string;
 
-        string.string = stringObject[RJsonKey::string].toString();
-        string.vaddr = stringObject[RJsonKey::vaddr].toVariant().toULongLong();
-        string.type = stringObject[RJsonKey::type].toString();
-        string.size = stringObject[RJsonKey::size].toVariant().toUInt();
-        string.length = stringObject[RJsonKey::length].toVariant().toUInt();
-        string.section = stringObject[RJsonKey::section].toString();
+        string.string = stringObject.toString("string");
+        string.vaddr = stringObject.toULongLong("vaddr");
+        string.type = stringObject.toString("type");
+        string.size = static_cast<ut32>(stringObject.toULongLong("size"));
+        string.length = static_cast<ut32>(stringObject.toULongLong("length"));
+        string.section = stringObject.toString("section");
 
         ret << string;
-    }
+        return true;
+    });
 
     return ret;
 }
 
 QList<FlagspaceDescription> IaitoCore::getAllFlagspaces()
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     QList<FlagspaceDescription> ret;
 
-    QJsonArray flagspacesArray = cmdj("fsj").array();
-    for (const QJsonValue value : flagspacesArray) {
-        QJsonObject flagspaceObject = value.toObject();
-
+    RSpaceIter it;
+    RSpace *space;
+    r_flag_space_foreach(core->flags, it, space) {
         FlagspaceDescription flagspace;
-
-        flagspace.name = flagspaceObject[RJsonKey::name].toString();
-
+        flagspace.name = QString::fromUtf8(space->name);
         ret << flagspace;
     }
     return ret;
@@ -2792,31 +3661,30 @@ QList<FlagspaceDescription> IaitoCore::getAllFlagspaces()
 
 QList<FlagDescription> IaitoCore::getAllFlags(QString flagspace)
 {
-    CORE_LOCK();
-    QList<FlagDescription> ret;
-
-    if (!flagspace.isEmpty())
-        cmdRaw("fs " + flagspace);
-    else
-        cmdRaw("fs *");
-
-    QJsonArray flagsArray = cmdj("fj").array();
-    for (const QJsonValue value : flagsArray) {
-        QJsonObject flagObject = value.toObject();
-
-        FlagDescription flag;
-
-        flag.offset = flagObject[RJsonKey::offset].toVariant().toULongLong();
-        flag.size = flagObject[RJsonKey::size].toVariant().toULongLong();
-        flag.name = flagObject[RJsonKey::name].toString();
-        flag.realname = flagObject[RJsonKey::realname].toString();
-
-        ret << flag;
-    }
-    return ret;
+    return cachedQuery<QList<FlagDescription>>(QStringLiteral("getAllFlags:") + flagspace, [this, flagspace]() -> QList<FlagDescription> {
+        CORE_LOCK_SHARED();
+        const RSpace *space = nullptr;
+        if (!flagspace.isEmpty()) {
+            space = r_flag_space_get(core->flags, flagspace.toUtf8().constData());
+            if (!space) {
+                return QList<FlagDescription>();
+            }
+        }
+        return NativeDescriptions::flags(core, space);
+    });
 }
 
 QList<SectionDescription> IaitoCore::getAllSections()
+{
+    return cachedQuery<QList<SectionDescription>>(QStringLiteral("getAllSections"), [this]() -> QList<SectionDescription> {
+        CORE_LOCK();
+        bool ok;
+        QList<SectionDescription> sections = NativeDescriptions::sections(core, &ok);
+        return ok ? sections : getAllSectionsJson();
+    });
+}
+
+QList<SectionDescription> IaitoCore::getAllSectionsJson()
 {
     CORE_LOCK();
     QList<SectionDescription> sections;
@@ -2847,6 +3715,26 @@ QList<SectionDescription> IaitoCore::getAllSections()
 }
 
 QStringList IaitoCore::getSectionList()
+{
+    return cachedQuery<QStringList>(QStringLiteral("getSectionList"), [this]() -> QStringList {
+        CORE_LOCK();
+        if (!r_bin_cur_object(core->bin)) {
+            return getSectionListJson();
+        }
+
+        QStringList ret;
+        RListIter *it;
+        RBinSection *sect;
+        IaitoRListForeach(r_bin_get_sections(core->bin), it, RBinSection, sect) {
+            if (!sect->is_segment) {
+                ret << QString::fromUtf8(sect->name);
+            }
+        }
+        return ret;
+    });
+}
+
+QStringList IaitoCore::getSectionListJson()
 {
     CORE_LOCK();
     QStringList ret;
@@ -2859,6 +3747,37 @@ QStringList IaitoCore::getSectionList()
 }
 
 QList<SegmentDescription> IaitoCore::getAllSegments()
+{
+    return cachedQuery<QList<SegmentDescription>>(QStringLiteral("getAllSegments"), [this]() -> QList<SegmentDescription> {
+        CORE_LOCK();
+        if (!r_bin_cur_object(core->bin)) {
+            return getAllSegmentsJson();
+        }
+
+        QList<SegmentDescription> ret;
+
+        RListIter *it;
+        RBinSection *sect;
+        IaitoRListForeach(r_bin_get_sections(core->bin), it, RBinSection, sect) {
+            if (!sect->is_segment || !sect->name || !*sect->name) {
+                continue;
+            }
+
+            SegmentDescription segment;
+            segment.name = QString::fromUtf8(sect->name);
+            segment.vaddr = r_bin_get_vaddr(core->bin, sect->paddr, sect->vaddr);
+            segment.paddr = sect->paddr;
+            segment.size = sect->size;
+            segment.vsize = sect->vsize;
+            segment.perm = QString::fromUtf8(r_str_rwx_i(sect->perm));
+
+            ret << segment;
+        }
+        return ret;
+    });
+}
+
+QList<SegmentDescription> IaitoCore::getAllSegmentsJson()
 {
     CORE_LOCK();
     QList<SegmentDescription> ret;
@@ -2886,6 +3805,35 @@ QList<SegmentDescription> IaitoCore::getAllSegments()
 }
 
 QList<EntrypointDescription> IaitoCore::getAllEntrypoint()
+{
+    CORE_LOCK();
+    RBinObject *obj = r_bin_cur_object(core->bin);
+    if (!obj) {
+        return getAllEntrypointJson();
+    }
+
+    QList<EntrypointDescription> ret;
+    const RVA baddr = r_bin_get_baddr(core->bin);
+    const RVA laddr = r_bin_get_laddr(core->bin);
+
+    RListIter *it;
+    RBinAddr *entry;
+    IaitoRListForeach(obj->entries, it, RBinAddr, entry) {
+        EntrypointDescription entrypoint;
+
+        entrypoint.vaddr = r_bin_get_vaddr(core->bin, entry->paddr, entry->vaddr);
+        entrypoint.paddr = entry->paddr;
+        entrypoint.baddr = baddr;
+        entrypoint.laddr = laddr;
+        entrypoint.haddr = entry->hpaddr;
+        entrypoint.type = QString::fromUtf8(r_bin_entry_type_string(entry->type));
+
+        ret << entrypoint;
+    }
+    return ret;
+}
+
+QList<EntrypointDescription> IaitoCore::getAllEntrypointJson()
 {
     CORE_LOCK();
     QList<EntrypointDescription> ret;
@@ -3372,39 +4320,42 @@ QList<SearchDescription> IaitoCore::getAllSearch(QString search_for, QString spa
     CORE_LOCK();
     QList<SearchDescription> searchRef;
 
-    QJsonArray searchArray = cmdj(space + QString(" ") + search_for).array();
+    const QString command = space + QString(" ") + search_for;
 
     if (space == "/Rj") {
-        for (const QJsonValue value : searchArray) {
-            QJsonObject searchObject = value.toObject();
-
+        cmdjForEachObject(command, [&searchRef](const JsonStreamObject &searchObject) {
             SearchDescription exp;
 
             exp.code.clear();
-            for (const QJsonValue value2 : searchObject[RJsonKey::opcodes].toArray()) {
-                QJsonObject gadget = value2.toObject();
-                exp.code += gadget[RJsonKey::opcode].toString() + ";  ";
+            bool first = true;
+            searchObject.forEachObject("opcodes", [&](const JsonStreamObject &gadget) {
+                if (first) {
+                    exp.offset = gadget.toULongLong("offset");
+                    first = false;
+                }
+                exp.code += gadget.toString("opcode") + ";  ";
+                return true;
+            });
+            if (first) {
+                exp.offset = 0;
             }
-
-            exp.offset =
-                searchObject[RJsonKey::opcodes].toArray().first().toObject()[RJsonKey::offset].toVariant().toULongLong();
-            exp.size = searchObject[RJsonKey::size].toVariant().toULongLong();
+            exp.size = static_cast<int>(searchObject.toULongLong("size"));
 
             searchRef << exp;
-        }
+            return true;
+        });
     } else {
-        for (const QJsonValue value : searchArray) {
-            QJsonObject searchObject = value.toObject();
-
+        cmdjForEachObject(command, [&searchRef](const JsonStreamObject &searchObject) {
             SearchDescription exp;
 
-            exp.offset = searchObject[RJsonKey::offset].toVariant().toULongLong();
-            exp.size = searchObject[RJsonKey::len].toVariant().toULongLong();
-            exp.code = searchObject[RJsonKey::code].toString();
-            exp.data = searchObject[RJsonKey::data].toString();
+            exp.offset = searchObject.toULongLong("offset");
+            exp.size = static_cast<int>(searchObject.toULongLong("len"));
+            exp.code = searchObject.toString("code");
+            exp.data = searchObject.toString("data");
 
             searchRef << exp;
-        }
+            return true;
+        });
     }
     return searchRef;
 }
@@ -3503,31 +4454,23 @@ QList<XrefDescription> IaitoCore::getXRefs(RVA addr, bool to, bool whole_functio
 {
     QList<XrefDescription> xrefList = QList<XrefDescription>();
 
-    QJsonArray xrefsArray;
-
-    if (to) {
-        xrefsArray = cmdj("axtj@" + QString::number(addr)).array();
-    } else {
-        xrefsArray = cmdj("axfj@" + QString::number(addr)).array();
-    }
-
-    for (const QJsonValue value : xrefsArray) {
-        QJsonObject xrefObject = value.toObject();
+    const QString command = (to ? "axtj@" : "axfj@") + QString::number(addr);
 
+    cmdjForEachObject(command, [&](const JsonStreamObject &xrefObject) {
         XrefDescription xref;
 
-        xref.type = xrefObject[RJsonKey::type].toString();
+        xref.type = xrefObject.toString("type");
 
         if (!filterType.isNull() && filterType != xref.type)
-            continue;
+            return true;
 
-        xref.from = xrefObject[RJsonKey::from].toVariant().toULongLong();
+        xref.from = xrefObject.toULongLong("from");
         if (!to) {
             xref.from_str = RAddressString(xref.from);
         } else {
-            QString fcn = xrefObject[RJsonKey::fcn_name].toString();
+            QString fcn = xrefObject.toString("fcn_name");
             if (!fcn.isEmpty()) {
-                RVA fcnAddr = xrefObject[RJsonKey::fcn_addr].toVariant().toULongLong();
+                RVA fcnAddr = xrefObject.toULongLong("fcn_addr");
                 xref.from_str = fcn + " + 0x" + QString::number(xref.from - fcnAddr, 16);
             } else {
                 xref.from_str = RAddressString(xref.from);
@@ -3535,18 +4478,19 @@ QList<XrefDescription> IaitoCore::getXRefs(RVA addr, bool to, bool whole_functio
         }
 
         if (!whole_function && !to && xref.from != addr) {
-            continue;
+            return true;
         }
 
-        if (to && !xrefObject.contains(RJsonKey::to)) {
+        if (to && !xrefObject.contains("to")) {
             xref.to = addr;
         } else {
-            xref.to = xrefObject[RJsonKey::to].toVariant().toULongLong();
+            xref.to = xrefObject.toULongLong("to");
         }
         xref.to_str = Core()->cmdRaw(QString("fd %1").arg(xref.to)).trimmed();
 
         xrefList << xref;
-    }
+        return true;
+    });
 
     return xrefList;
 }
@@ -3565,12 +4509,71 @@ void IaitoCore::addFlag(RVA offset, QString name, RVA size)
  */
 QString IaitoCore::listFlagsAsStringAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_LOCK_SHARED();
     char *flagList = r_flag_get_liststr (core->flags, addr);
     QString result = fromOwnedCharPtr(flagList);
     return result;
 }
 
+static AddressMetaDescription &addressMetaAt(QMap<RVA, AddressMetaDescription> &meta, RVA offset)
+{
+    auto it = meta.find(offset);
+    if (it == meta.end()) {
+        it = meta.insert(offset, { offset, QString(), QString() });
+    }
+    return it.value();
+}
+
+QVector<AddressMetaDescription> IaitoCore::getAddressMetaInRange(RVA start, RVA end)
+{
+    if (end <= start) {
+        return {};
+    }
+
+    QMap<RVA, AddressMetaDescription> meta;
+
+    CORE_LOCK_SHARED();
+
+    // Seek to the first flagged offset in range in the offset ordered skiplist
+    // instead of having r_flag_foreach_range() filter every flag
+    RSkipList *byOffset = core->flags->by_off;
+    RFlagsAtOffset key = {};
+    key.off = start;
+    for (RSkipListNode *node = r_skiplist_find_geq(byOffset, &key); node && node != byOffset->head;
+            node = node->forward[0]) {
+        auto flagsAt = reinterpret_cast<RFlagsAtOffset *>(node->data);
+        if (flagsAt->off >= end) {
+            break;
+        }
+        RListIter *it;
+        RFlagItem *fi;
+        IaitoRListForeach(flagsAt->flags, it, RFlagItem, fi) {
+            QString &flags = addressMetaAt(meta, fi->offset).flags;
+            if (!flags.isEmpty()) {
+                flags += QLatin1Char(',');
+            }
+            flags += QString::fromUtf8(fi->realname ? fi->realname : fi->name);
+        }
+    }
+
+    RPVector *comments = r_meta_get_all_intersect(core->anal, start, end - start, R_META_TYPE_COMMENT);
+    if (comments) {
+        void **it;
+        r_pvector_foreach(comments, it) {
+            auto node = reinterpret_cast<RIntervalNode *>(*it);
+            auto item = reinterpret_cast<RAnalMetaItem *>(node->data);
+            // Like getCommentAt(), only comments starting at the address count
+            if (node->start < start || node->start >= end || !item->str) {
+                continue;
+            }
+            addressMetaAt(meta, node->start).comment = QString::fromUtf8(item->str);
+        }
+        r_pvector_free(comments);
+    }
+
+    return meta.values().toVector();
+}
+
 QString IaitoCore::nearestFlag(RVA offset, RVA *flagOffsetOut)
 {
     auto r = cmdj(QString("fdj @") + QString::number(offset)).object();
@@ -3584,6 +4587,8 @@ QString IaitoCore::nearestFlag(RVA offset, RVA *flagOffsetOut)
 
 void IaitoCore::handleREvent(int type, void *data)
 {
+    bumpAnalysisGeneration();
+
     switch (type) {
     case R_EVENT_CLASS_NEW: {
         auto ev = reinterpret_cast<REventClass *>(data);
@@ -3676,6 +4681,64 @@ bool IaitoCore::isProjectNameValid(const QString &name)
 }
 
 QList<DisassemblyLine> IaitoCore::disassembleLines(RVA offset, int lines)
+{
+    CORE_LOCK();
+    // Emulation and the lines column depend on where the pdJ window started,
+    // the lines of one instruction can not be reused in another window
+    if (r_config_get_i(core->config, "asm.emu") || r_config_get_i(core->config, "asm.lines")) {
+        queryCacheMisses++;
+        return disassembleLinesUncached(offset, lines);
+    }
+    const quint64 configKey = disassemblyConfigKey();
+    const quint64 generation = getAnalysisGeneration();
+    if (generation != disassemblyCacheGeneration || disassemblyCache.size() > 100000) {
+        disassemblyCache.clear();
+        disassemblyCacheGeneration = generation;
+    }
+
+    QList<DisassemblyLine> r;
+    RVA addr = offset;
+    while (r.size() < lines) {
+        auto it = disassemblyCache.constFind(qMakePair(addr, configKey));
+        if (it == disassemblyCache.constEnd()) {
+            break;
+        }
+        r.append(it->lines);
+        if (it->next <= addr) { // overflow
+            lines = r.size();
+            break;
+        }
+        addr = it->next;
+    }
+    if (r.size() >= lines) {
+        queryCacheHits++;
+        return r.mid(0, lines);
+    }
+    queryCacheMisses++;
+
+    const int wanted = lines - r.size();
+    const QList<DisassemblyLine> fetched = disassembleLinesUncached(addr, wanted);
+
+    // Store every instruction but the last one, which may have been cut and has no known successor.
+    // The key already covers temporary configurations, so previews share entries with each other.
+    int groupStart = 0;
+    for (int i = 1; i < fetched.size(); i++) {
+        if (fetched[i].offset == fetched[groupStart].offset) {
+            continue;
+        }
+        if (fetched[i].offset < fetched[groupStart].offset) { // overflow
+            break;
+        }
+        disassemblyCache.insert(qMakePair(fetched[groupStart].offset, configKey),
+                                { fetched.mid(groupStart, i - groupStart), fetched[i].offset });
+        groupStart = i;
+    }
+
+    r.append(fetched);
+    return r.mid(0, lines);
+}
+
+QList<DisassemblyLine> IaitoCore::disassembleLinesUncached(RVA offset, int lines)
 {
     QJsonArray array = cmdj(QString("pdJ ") + QString::number(lines) + QString(" @ ") + QString::number(
                                 offset)).array();
@@ -3696,6 +4759,38 @@ QList<DisassemblyLine> IaitoCore::disassembleLines(RVA offset, int lines)
     return r;
 }
 
+quint64 IaitoCore::disassemblyConfigKey()
+{
+    CORE_LOCK();
+    // FNV-1a over the names and values
+    quint64 hash = 14695981039346656037ull;
+    auto add = [&hash](const char *str) {
+        for (; str && *str; str++) {
+            hash = (hash ^ static_cast<ut8>(*str)) * 1099511628211ull;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ull;
+    };
+    RListIter *iter;
+    RConfigNode *node;
+    IaitoRListForeach(core->config->nodes, iter, RConfigNode, node) {
+        if (r_str_startswith(node->name, "asm.") || r_str_startswith(node->name, "scr.")
+                || r_str_startswith(node->name, "cfg.")) {
+            add(node->name);
+            add(node->value);
+        }
+    }
+    // The text is colored with the palette, which themes change without touching the config
+    for (int i = 0; i < r_cons_pal_len(); i++) {
+        const RColor color = r_cons_pal_get_i(i);
+        const ut8 values[] = { color.attr, color.a, color.r, color.g, color.b,
+                               color.r2, color.g2, color.b2, static_cast<ut8>(color.id16) };
+        for (ut8 value : values) {
+            hash = (hash ^ value) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
 
 /**
  * @brief return hexdump of <size> from an <offset> by a given formats
@@ -3820,14 +4915,7 @@ QList<QString> IaitoCore::getColorThemes()
 
 QString IaitoCore::ansiEscapeToHtml(const QString &text)
 {
-    int len;
-    char *html = r_cons_html_filter(text.toUtf8().constData(), &len);
-    if (!html) {
-        return QString();
-    }
-    QString r = QString::fromUtf8(html, len);
-    r_mem_free(html);
-    return r;
+    return RichTextPainter::toHtml(RichTextPainter::fromAnsi(text));
 }
 
 BasicBlockHighlighter* IaitoCore::getBBHighlighter()
@@ -3962,6 +5050,8 @@ QString IaitoCore::getHexdumpPreview(RVA address, int size)
 
 QByteArray IaitoCore::ioRead(RVA addr, int len)
 {
+    // r_io_read_at moves the seek of the RIODesc/RBuffer and fills the io cache,
+    // concurrent reads would race on both
     CORE_LOCK();
 
     QByteArray array;
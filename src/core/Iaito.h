@@ -4,6 +4,8 @@
 #include "core/IaitoCommon.h"
 #include "core/IaitoDescriptions.h"
 #include "common/BasicInstructionHighlighter.h"
+#include "common/JsonStream.h"
+#include "common/InstructionIndex.h"
 
 #include <QMap>
 #include <QMenu>
@@ -14,8 +16,15 @@
 #include <QJsonDocument>
 #include <QErrorMessage>
 #include <QMutex>
+#include <QReadWriteLock>
 #include <QDir>
+#include <QHash>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class AsyncTask;
 class AsyncTaskManager;
 class BasicInstructionHighlighter;
 class IaitoCore;
@@ -32,6 +41,30 @@ class R2TaskDialog;
 
 class RCoreLocked;
 
+/**
+ * @brief Counters of the global core lock, see IaitoCore::getCoreLockStats()
+ */
+struct CoreLockStats {
+    quint64 exclusiveLocks = 0;
+    quint64 sharedLocks = 0;
+    /** Number of acquisitions that had to wait for another thread */
+    quint64 contendedLocks = 0;
+    quint64 totalWaitNs = 0;
+    quint64 guiThreadContendedLocks = 0;
+    quint64 guiThreadWaitNs = 0;
+    quint64 maxGuiThreadWaitNs = 0;
+};
+
+/**
+ * @brief Counters of the query result cache, see IaitoCore::getQueryCacheStats()
+ */
+struct QueryCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    /** Current analysis generation, bumped by every change of the r2 state */
+    quint64 generation = 0;
+};
+
 class IAITO_EXPORT IaitoCore: public QObject
 {
     Q_OBJECT
@@ -90,8 +123,9 @@ public:
     QString cmdRaw(const QString &cmd) { return cmdRaw(cmd.toUtf8().constData()); };
 
     /**
-     * @brief Execute a radare2 command \a cmd at \a address. The function will preform a silent seek to the address
-     * without triggering the seekChanged event nor adding new entries to the seek history. By nature, the
+     * @brief Execute a radare2 command \a cmd at \a address. The core offset only changes for the duration
+     * of the command, within the same critical section, so the seek history, the seekChanged event and
+     * other threads never see it. By nature, the
      * API is executing a single command without going through radare2 shell, and thus ignores multiple commands 
      * and tries to overcome command injections.
      * @param cmd - a raw command to execute. If multiple commands will be passed (e.g "px 5; pd 7 && pdf") then
@@ -108,11 +142,49 @@ public:
     
     QJsonDocument cmdj(const char *str);
     QJsonDocument cmdj(const QString &str) { return cmdj(str.toUtf8().constData()); }
+    /**
+     * @brief Execute \a str at \a address without seeking, see cmdRawAt().
+     */
     QJsonDocument cmdjAt(const char *str, RVA address);
+    /**
+     * @brief Execute \a str and call \a callback for every element of the top level array
+     * of its JSON output. The output is tokenized in place, only one element at a time is
+     * materialized and no QJsonDocument is built for the whole output.
+     * @param callback - return false to stop the iteration
+     * @return false if the output is not a JSON array
+     */
+    bool cmdjForEach(const char *str, const std::function<bool(const QJsonValue &)> &callback);
+    bool cmdjForEach(const QString &str, const std::function<bool(const QJsonValue &)> &callback)
+    {
+        return cmdjForEach(str.toUtf8().constData(), callback);
+    }
+    /**
+     * @brief Typed variant of cmdjForEach() for arrays of objects. Members of each element
+     * are decoded on access, see JsonStreamObject.
+     */
+    bool cmdjForEachObject(const char *str, const std::function<bool(const JsonStreamObject &)> &callback);
+    bool cmdjForEachObject(const QString &str, const std::function<bool(const JsonStreamObject &)> &callback)
+    {
+        return cmdjForEachObject(str.toUtf8().constData(), callback);
+    }
     QStringList cmdList(const char *str) { return cmd(str).split(QLatin1Char('\n'), IAITO_QT_SKIP_EMPTY_PARTS); }
     QStringList cmdList(const QString &str) { return cmdList(str.toUtf8().constData()); }
-    QString cmdTask(const QString &str);
-    QJsonDocument cmdjTask(const QString &str);
+    /**
+     * @brief Execute each of \a commands like cmd() does, taking the core lock and
+     * pushing the r_cons context only once for the whole list.
+     * Use it for refreshes that issue many small commands in a row.
+     * @param address - if valid, all commands run at this address, as with cmdRawAt()
+     * @return the output of every command, in the same order as \a commands
+     */
+    QStringList cmdBatch(const QStringList &commands, RVA address = RVA_INVALID);
+    /**
+     * @brief Run \a str as an r2 task and wait for it.
+     * @param owner if set, the command is broken as soon as owner is interrupted.
+     * The break is repeated until the command returns, since r2 resets it when a
+     * command pushes its own break handler.
+     */
+    QString cmdTask(const QString &str, AsyncTask *owner = nullptr);
+    QJsonDocument cmdjTask(const QString &str, AsyncTask *owner = nullptr);
     /**
      * @brief send a command to radare2 and check for ESIL errors
      * @param command the command you want to execute
@@ -182,6 +254,12 @@ public:
     void delFlag(const QString &name);
     void addFlag(RVA offset, QString name, RVA size);
     QString listFlagsAsStringAt(RVA addr);
+    /**
+     * @brief Flags and comments of every address in [start, end), sorted by address.
+     * Addresses without any of them are omitted. Meant to be fetched once per
+     * view update instead of calling listFlagsAsStringAt() and getCommentAt() per item.
+     */
+    QVector<AddressMetaDescription> getAddressMetaInRange(RVA start, RVA end);
     /**
      * @brief Get nearest flag at or before offset.
      * @param offset search position
@@ -287,7 +365,16 @@ public:
      */
     void seekAndShow(QString thing);
     RVA getOffset();
+    /**
+     * @brief Start of the instruction \a count instructions before \a startAddr.
+     * Looked up in the instruction index, which is filled from the basic blocks of the
+     * surrounding function or by decoding linearly, and falls back to "/O".
+     */
     RVA prevOpAddr(RVA startAddr, int count);
+    /**
+     * @brief Start of the instruction \a count instructions after \a startAddr
+     * @see prevOpAddr()
+     */
     RVA nextOpAddr(RVA startAddr, int count);
 
     /* Math functions */
@@ -321,6 +408,11 @@ public:
     QByteArray assemble(const QString &code);
     QString disassemble(const QByteArray &data);
     QString disassembleSingleInstruction(RVA addr);
+    /**
+     * @brief \a lines lines of "pdJ" starting at \a offset, with the text converted to HTML.
+     * Instructions are cached by address and the asm.*, scr.* and cfg.* settings they were
+     * printed with until the analysis generation changes.
+     */
     QList<DisassemblyLine> disassembleLines(RVA offset, int lines);
 
     static QByteArray hexStringToBytes(const QString &hex);
@@ -343,6 +435,13 @@ public:
     QJsonDocument getRegisterValues();
     QString getRegisterName(QString registerRole);
     RVA getProgramCounterValue();
+    /**
+     * @brief Value of a register, or of the register with a role like "PC" or "SP",
+     * from the arena "dr" shows: the debugger's, synced from the target, with cfg.debug
+     * and the ESIL one otherwise. Unlike "dr" it does not count as a modifying command.
+     * @return RVA_INVALID if there is no such register
+     */
+    RVA getRegisterValue(const char *name);
     void setRegister(QString regName, QString regValue);
     void setCurrentDebugThread(int tid);
     /**
@@ -350,23 +449,26 @@ public:
      */
     void setCurrentDebugProcess(int pid);
     /**
-     * @brief Returns a list of stack address and their telescoped references
+     * @brief Returns the stack slots and their telescoped references, the first step of every
+     *        chain is the slot itself
      * @param size number of bytes to scan
-     * @param depth telescoping depth 
+     * @param depth telescoping depth
      */
-    QList<QJsonObject> getStack(int size = 0x100, int depth = 6);
+    QVector<AddrRefChain> getStack(int size = 0x100, int depth = 6);
     /**
-     * @brief Recursively dereferences pointers starting at the specified address
-     *        up to a given depth
-     * @param addr telescoping addr
-     * @param depth telescoping depth 
+     * @brief Dereferences pointers starting at each of the specified addresses up to a given depth.
+     *        All chains are resolved together one level at a time, reading nearby addresses at once,
+     *        and resolved addresses are remembered until the analysis generation changes.
+     * @param addrs telescoping addrs
+     * @param depth telescoping depth
      */
-    QJsonObject getAddrRefs(RVA addr, int depth);
+    QVector<AddrRefChain> getAddrRefs(const QVector<RVA> &addrs, int depth);
     /**
      * @brief return a RefDescription with a formatted ref string and configured colors
-     * @param ref the "ref" JSON node from getAddrRefs
+     * @param refs chain from getAddrRefs
+     * @param first first step of the chain to describe
      */
-    RefDescription formatRefDesc(QJsonObject ref);
+    RefDescription formatRefDesc(const AddrRefChain &refs, int first = 0);
     /**
      * @brief Get a list of a given process's threads
      * @param pid The pid of the process, -1 for the currently debugged process
@@ -571,7 +673,7 @@ public:
      * @brief returns a list of reg values and their telescoped references
      * @param depth telescoping depth
      */
-    QList<QJsonObject> getRegisterRefs(int depth = 6);
+    QVector<RegisterRefChain> getRegisterRefs(int depth = 6);
     QVector<RegisterRefValueDescription> getRegisterRefValues();
     QList<VariableDescription> getVariables(RVA at);
     /**
@@ -588,8 +690,6 @@ public:
     QList<XrefDescription> getXRefs(RVA addr, bool to, bool whole_function,
                                     const QString &filterType = QString());
 
-    QList<StringDescription> parseStringsJson(const QJsonDocument &doc);
-
     void handleREvent(int type, void *data);
 
     /* Signals related */
@@ -604,6 +704,42 @@ public:
     QStringList getSectionList();
 
     RCoreLocked core();
+    /**
+     * @brief Lock the core for a pure query that does not run commands or modify any r2 state.
+     * Shared locks can be held by several threads at once but exclude every RCoreLocked
+     * returned by core(). Code holding a shared lock must not call anything that takes
+     * the exclusive one.
+     */
+    RCoreLocked coreShared();
+
+    /**
+     * @brief Statistics about the core lock contention since the last resetCoreLockStats()
+     */
+    CoreLockStats getCoreLockStats() const;
+    void resetCoreLockStats();
+
+    /**
+     * @brief Invalidate every cached query result.
+     * Commands going through IaitoCore and R2Task do this on their own unless they are
+     * read-only, it is only needed after changing the r2 state through the C API directly.
+     */
+    void bumpAnalysisGeneration()       { analysisGeneration++; }
+    /**
+     * @brief Called by TempConfig. While a temporary configuration is active its changes
+     * do not bump the generation and cached query results are neither used nor stored.
+     * Restoring io.*, cfg.* or the asm.* keys that change decoding bumps it once at the end.
+     */
+    void beginTempConfig();
+    void endTempConfig();
+    quint64 getAnalysisGeneration() const { return analysisGeneration.load(); }
+    QueryCacheStats getQueryCacheStats() const;
+    void resetQueryCacheStats();
+    /**
+     * @brief Whether \a cmd is known not to modify the analysis, flags, metadata or
+     * configuration, i.e. running it does not need to invalidate cached query results.
+     * Unknown commands are considered mutating.
+     */
+    static bool isReadOnlyCommand(const char *cmd);
 
     static QString ansiEscapeToHtml(const QString &text);
     BasicBlockHighlighter *getBBHighlighter();
@@ -710,19 +846,108 @@ signals:
 private:
     QString notes;
 
+    /**
+     * @brief Bump the generation after setConfig(), or once the temporary configuration
+     * is restored if \a k changes what cached results were read or decoded with
+     */
+    void configChanged(const char *k);
+
     /**
      * Internal reference to the RCore.
      * NEVER use this directly! Always use the CORE_LOCK(); macro and access it like core->...
      */
     RCore *core_ = nullptr;
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    QMutex coreMutex;
-#else
-    QRecursiveMutex coreMutex;
-#endif
+    /**
+     * Exclusive for commands, shared for pure queries. Recursion is handled
+     * per thread by RCoreLocked since QReadWriteLock can't mix both modes.
+     */
+    QReadWriteLock coreLock;
+    /** Protects coreLockDepth and coreBed, which shared lockers update concurrently */
+    QMutex coreBedMutex;
     int coreLockDepth = 0;
     void *coreBed = nullptr;
 
+    std::atomic<quint64> lockStatExclusive { 0 };
+    std::atomic<quint64> lockStatShared { 0 };
+    std::atomic<quint64> lockStatContended { 0 };
+    std::atomic<quint64> lockStatWaitNs { 0 };
+    std::atomic<quint64> lockStatGuiContended { 0 };
+    std::atomic<quint64> lockStatGuiWaitNs { 0 };
+    std::atomic<quint64> lockStatGuiMaxWaitNs { 0 };
+
+    void acquireCoreLock(bool shared);
+    void releaseCoreLock();
+
+    struct QueryCacheEntry {
+        quint64 generation;
+        std::shared_ptr<const void> value;
+    };
+    std::atomic<quint64> analysisGeneration { 0 };
+    QMutex queryCacheMutex;
+    QHash<QString, QueryCacheEntry> queryCache;
+    std::atomic<quint64> queryCacheHits { 0 };
+    std::atomic<quint64> queryCacheMisses { 0 };
+
+    /**
+     * @brief Return the result of \a compute stored under \a key, or run it if the
+     * analysis changed since it was stored.
+     */
+    template<typename T, typename Func>
+    T cachedQuery(const QString &key, Func compute);
+
+    /** Number of TempConfig objects alive, on any thread */
+    std::atomic<int> tempConfigCount { 0 };
+
+    struct DisassemblyCacheEntry {
+        /** Every pdJ line printed for the instruction */
+        QList<DisassemblyLine> lines;
+        /** Offset of the line following the instruction */
+        RVA next;
+    };
+    /** By instruction address and disassemblyConfigKey(), only accessed with the core lock held exclusively */
+    QHash<QPair<RVA, quint64>, DisassemblyCacheEntry> disassemblyCache;
+    quint64 disassemblyCacheGeneration = 0;
+    /**
+     * @brief Hash of every setting and palette color that changes what pd prints
+     */
+    quint64 disassemblyConfigKey();
+    QList<DisassemblyLine> disassembleLinesUncached(RVA offset, int lines);
+
+    /** Resolved telescoping step without string, and the bytes at its address */
+    struct TelescopeEntry {
+        AddrRefDescription desc;
+        QByteArray bytes;
+    };
+    /** Only accessed with the core lock held exclusively */
+    QHash<RVA, TelescopeEntry> telescopeMemo;
+    quint64 telescopeMemoGeneration = 0;
+    /**
+     * @brief Add the addresses missing from telescopeMemo, reading neighbouring ones together
+     */
+    void resolveTelescopeEntries(QVector<RVA> addrs);
+    /**
+     * @param type result of r_core_anal_address()
+     * @param bytes memory at addr, only needed if it is readable or executable
+     */
+    TelescopeEntry makeTelescopeEntry(RVA addr, ut64 type, const QByteArray &bytes);
+
+    /** Instruction boundaries, only accessed with the core lock held exclusively */
+    InstructionIndex instructionIndex;
+    quint64 instructionIndexGeneration = 0;
+    QList<RVA> indexedFunctions;
+
+    /**
+     * @brief Step \a count instructions from \a addr using instructionIndex, extending it if needed
+     * @return RVA_INVALID if \a addr can not be indexed as an instruction start
+     */
+    RVA stepInstructions(RVA addr, int count);
+    void indexFunctionInstructions(RAnalFunction *fcn);
+    /**
+     * @brief Decode forward from \a from until \a count instructions were decoded or \a until is reached
+     * @return the decoded run, empty if it does not end exactly at \a until (when given)
+     */
+    InstructionIndex::Run decodeInstructions(RVA from, RVA until, int count);
+
     AsyncTaskManager *asyncTaskManager;
     RVA offsetPriorDebugging = RVA_INVALID;
     QErrorMessage msgBox;
@@ -738,14 +963,36 @@ private:
     R2TaskDialog *debugTaskDialog;
     
     QVector<QString> getIaitoRCFilePaths() const;
+
+    bool forEachJsonObject(const char *res, const char *cmd,
+                           const std::function<bool(const JsonStreamObject &)> &callback);
+
+    /*
+     * JSON based fallbacks of the getAll* functions, only used when the
+     * native structures are not available (e.g. no RBin object loaded).
+     */
+    QList<ImportDescription> getAllImportsJson();
+    QList<HeaderDescription> getAllHeadersJson();
+    QList<StringDescription> getAllStringsJson();
+    QList<SectionDescription> getAllSectionsJson();
+    QStringList getSectionListJson();
+    QList<SegmentDescription> getAllSegmentsJson();
+    QList<EntrypointDescription> getAllEntrypointJson();
 };
 
 class IAITO_EXPORT RCoreLocked
 {
+public:
+    enum class Mode { Exclusive, Shared };
+
+private:
     IaitoCore * const core;
+    const Mode mode;
+    /** false if this thread already held a lock covering this one */
+    bool owner = false;
 
 public:
-    explicit RCoreLocked(IaitoCore *core);
+    explicit RCoreLocked(IaitoCore *core, Mode mode = Mode::Exclusive);
     RCoreLocked(const RCoreLocked &) = delete;
     RCoreLocked &operator=(const RCoreLocked &) = delete;
     RCoreLocked(RCoreLocked &&);
@@ -7,6 +7,7 @@
 
 #include <QString>
 #include <QList>
+#include <QVector>
 #include <QStringList>
 #include <QMetaType>
 #include <QColor>
@@ -122,6 +123,18 @@ struct FlagDescription {
     QString realname;
 };
 
+/**
+ * @brief Flags and comment starting at a single address, see IaitoCore::getAddressMetaInRange()
+ */
+struct AddressMetaDescription {
+    RVA offset;
+    /** Comma separated, like IaitoCore::listFlagsAsStringAt() */
+    QString flags;
+    QString comment;
+
+    bool operator<(const AddressMetaDescription &other) const { return offset < other.offset; }
+};
+
 struct SectionDescription {
     RVA vaddr;
     RVA paddr;
@@ -314,6 +327,37 @@ struct RefDescription {
     QColor refColor;
 };
 
+/**
+ * @brief One step of a telescoped pointer chain, see IaitoCore::getAddrRefs()
+ */
+struct AddrRefDescription {
+    RVA addr = RVA_INVALID;
+    QString mapName;
+    QString section;
+    QString reg;
+    QString fcn;
+    QString type;
+    QString perms;
+    QString asmText;
+    /** Text at addr, only set if the next step of the chain is ascii */
+    QString string;
+    /** Pointer sized value at addr, only read from readable, non-executable memory */
+    bool hasValue = false;
+    RVA value = 0;
+};
+
+/**
+ * @brief Every step after the first one describes the value of the step before
+ */
+typedef QVector<AddrRefDescription> AddrRefChain;
+
+struct RegisterRefChain {
+    QString name;
+    RVA value = 0;
+    /** Starts with the register value */
+    AddrRefChain refs;
+};
+
 struct VariableDescription {
     enum class RefType { SP, BP, Reg };
     RefType refType;
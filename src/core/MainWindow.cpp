@@ -38,6 +38,7 @@
 #include "widgets/SectionsWidget.h"
 #include "widgets/SegmentsWidget.h"
 #include "widgets/CommentsWidget.h"
+#include "widgets/CommandProfilerWidget.h"
 #include "widgets/ImportsWidget.h"
 #include "widgets/ExportsWidget.h"
 #include "widgets/TypesWidget.h"
@@ -368,6 +369,7 @@ void MainWindow::initDocks()
     typesDock = new TypesWidget(this);
     searchDock = new SearchWidget(this);
     commentsDock = new CommentsWidget(this);
+    commandProfilerDock = new CommandProfilerWidget(this);
     stringsDock = new StringsWidget(this);
 
     QList<IaitoDockWidget *> debugDocks = {
@@ -430,6 +432,7 @@ void MainWindow::initDocks()
     QList<IaitoDockWidget *> windowDocks2 = {
         consoleDock,
         commentsDock,
+        commandProfilerDock,
         nullptr,
     };
     ui->menuWindows->addActions(makeActionList(windowDocks2));
@@ -531,6 +534,7 @@ void MainWindow::addMenuFileAction(QAction *action)
 void MainWindow::openNewFile(InitialOptions &options, bool skipOptionsDialog)
 {
     setFilename(options.filename);
+    interruptedAnalysis.clear();
 
     /* Prompt to load filename.r2 script */
     if (options.script.isEmpty()) {
@@ -859,6 +863,7 @@ void MainWindow::restoreDocks()
     splitDockWidget(consoleDock, sectionsDock, Qt::Horizontal);
     tabifyDockWidget(sectionsDock, segmentsDock);
     tabifyDockWidget(sectionsDock, commentsDock);
+    tabifyDockWidget(sectionsDock, commandProfilerDock);
 
     // Add Stack, Registers, Threads and Backtrace vertically stacked
     splitDockWidget(stackDock, registersDock, Qt::Vertical);
@@ -1611,6 +1616,17 @@ void MainWindow::on_actionAnalyze_triggered()
     auto *analTask = new AnalTask();
     InitialOptions options;
     options.analCmd = { {"aaa", "Auto analysis"} };
+    if (!interruptedAnalysis.isEmpty()) {
+        QMessageBox mb(this);
+        mb.setWindowTitle(tr("Resume analysis"));
+        mb.setText(tr("The previous analysis was interrupted. Do you want to resume it "
+                      "instead of starting over?"));
+        mb.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+        if (mb.exec() == QMessageBox::Yes) {
+            options.analCmd = interruptedAnalysis;
+        }
+    }
+    interruptedAnalysis.clear();
     analTask->setOptions(options);
     AsyncTask::Ptr analTaskPtr(analTask);
 
@@ -1618,7 +1634,11 @@ void MainWindow::on_actionAnalyze_triggered()
     taskDialog->setInterruptOnClose(true);
     taskDialog->setAttribute(Qt::WA_DeleteOnClose);
     taskDialog->show();
-    connect(analTask, &AnalTask::finished, this, &MainWindow::refreshAll);
+    connect(analTask, &AnalTask::finished, this, [this, analTask]() {
+        // Empty unless there is something to resume
+        setInterruptedAnalysis(analTask->getRemainingPasses());
+        refreshAll();
+    });
 
     Core()->getAsyncTaskManager()->start(analTaskPtr);
 }
@@ -54,6 +54,7 @@ class DecompilerWidget;
 class OverviewWidget;
 class R2GraphWidget;
 class CallGraphWidget;
+class CommandProfilerWidget;
 
 namespace Ui {
 class MainWindow;
@@ -74,6 +75,11 @@ public:
     void displayWelcomeDialog();
     void closeNewFileDialog();
     void openProject(const QString &project_name);
+    /**
+     * @brief Remember the passes an interrupted analysis did not complete,
+     * "Analyze program" offers to resume with them
+     */
+    void setInterruptedAnalysis(const QList<CommandDescription> &passes) { interruptedAnalysis = passes; }
 
     /**
      * @param quit whether to show destructive button in dialog
@@ -226,6 +232,7 @@ private:
     ProgressIndicator *tasksProgressIndicator;
     QByteArray emptyState;
     IOModesController ioModesController;
+    QList<CommandDescription> interruptedAnalysis;
 
     Configuration *configuration;
 
@@ -266,6 +273,7 @@ private:
     R2GraphWidget      *r2GraphDock = nullptr;
     CallGraphWidget    *callGraphDock = nullptr;
     CallGraphWidget    *globalCallGraphDock = nullptr;
+    CommandProfilerWidget *commandProfilerDock = nullptr;
 
     QMenu *disassemblyContextMenuExtensions = nullptr;
     QMenu *addressableContextMenuExtensions = nullptr;
@@ -0,0 +1,101 @@
+#include "core/NativeDescriptions.h"
+
+#include "r_hash.h"
+
+#include <climits>
+
+QList<FlagDescription> NativeDescriptions::flags(RCore *core, const RSpace *space)
+{
+    QList<FlagDescription> ret;
+    r_flag_foreach_space(core->flags, space, [](RFlagItem *fi, void *user) -> bool {
+        FlagDescription flag;
+        flag.offset = fi->offset;
+        flag.size = fi->size;
+        flag.name = QString::fromUtf8(fi->name);
+        flag.realname = QString::fromUtf8(fi->realname);
+        reinterpret_cast<QList<FlagDescription> *>(user)->append(flag);
+        return true;
+    }, &ret);
+    return ret;
+}
+
+QList<StringDescription> NativeDescriptions::strings(RCore *core, bool *ok)
+{
+    QList<StringDescription> ret;
+    RBinFile *bf = r_bin_cur(core->bin);
+    RBinObject *obj = r_bin_cur_object(core->bin);
+    // Equivalent of "izz", without serializing every string to JSON first
+    RList *strings = bf && obj ? r_bin_raw_strings(bf, 0) : nullptr;
+    *ok = strings != nullptr;
+    if (!strings) {
+        return ret;
+    }
+    ret.reserve(r_list_length(strings));
+
+    RListIter *it;
+    RBinString *str;
+    IaitoRListForeach(strings, it, RBinString, str) {
+        StringDescription string;
+
+        string.string = QString::fromUtf8(str->string);
+        string.vaddr = r_bin_get_vaddr(core->bin, str->paddr, str->vaddr);
+        string.type = QString::fromUtf8(r_bin_string_type(str->type));
+        string.size = str->size;
+        string.length = str->length;
+        RBinSection *section = r_bin_get_section_at(obj, str->paddr, false);
+        if (section && section->name) {
+            string.section = QString::fromUtf8(section->name);
+        }
+
+        ret << string;
+    }
+    r_list_free(strings);
+    return ret;
+}
+
+/**
+ * @brief Shannon entropy of the section contents, formatted like "iSj entropy" does
+ */
+static QString sectionEntropy(RCore *core, RBinSection *section)
+{
+    // Same limit as r2, which leaves out the hashes of bigger sections
+    const ut64 hashLimit = r_config_get_i(core->config, "bin.hashlimit");
+    if (section->size == 0 || section->size >= hashLimit || section->size > INT_MAX) {
+        return QString();
+    }
+    QByteArray data(static_cast<int>(section->size), '\0');
+    if (!r_io_pread_at(core->io, section->paddr, reinterpret_cast<ut8 *>(data.data()), data.size())) {
+        return QString();
+    }
+    double entropy = r_hash_entropy(reinterpret_cast<const ut8 *>(data.constData()), data.size());
+    return QString::number(entropy, 'f', 8);
+}
+
+QList<SectionDescription> NativeDescriptions::sections(RCore *core, bool *ok)
+{
+    QList<SectionDescription> sections;
+    *ok = r_bin_cur_object(core->bin) != nullptr;
+    if (!*ok) {
+        return sections;
+    }
+
+    RListIter *it;
+    RBinSection *sect;
+    IaitoRListForeach(r_bin_get_sections(core->bin), it, RBinSection, sect) {
+        if (sect->is_segment || !sect->name || !*sect->name) {
+            continue;
+        }
+
+        SectionDescription section;
+        section.name = QString::fromUtf8(sect->name);
+        section.vaddr = r_bin_get_vaddr(core->bin, sect->paddr, sect->vaddr);
+        section.vsize = sect->vsize;
+        section.paddr = sect->paddr;
+        section.size = sect->size;
+        section.perm = QString::fromUtf8(r_str_rwx_i(sect->perm));
+        section.entropy = sectionEntropy(core, sect);
+
+        sections << section;
+    }
+    return sections;
+}
@@ -0,0 +1,35 @@
+#ifndef NATIVEDESCRIPTIONS_H
+#define NATIVEDESCRIPTIONS_H
+
+#include "core/IaitoDescriptions.h"
+
+/**
+ * @brief Description lists read straight from the RFlag/RBin structures, without having
+ * r2 serialize them to JSON first.
+ *
+ * They back the IaitoCore::getAll* functions, which hold the core lock while calling
+ * them, and are benchmarked against the JSON output in tests/NativeDescriptionsTest.cpp.
+ */
+namespace NativeDescriptions {
+
+/**
+ * @brief Flags of \a space, of every flagspace if it is null, like "fj".
+ * Unlike "fs <space>; fj" this does not change the current flagspace.
+ */
+IAITO_EXPORT QList<FlagDescription> flags(RCore *core, const RSpace *space);
+
+/**
+ * @brief Strings of the whole current file, like "izzj"
+ * @param ok set to false if there is no bin object to read them from
+ */
+IAITO_EXPORT QList<StringDescription> strings(RCore *core, bool *ok);
+
+/**
+ * @brief Sections of the current bin object, like "iSj entropy"
+ * @param ok set to false if there is no bin object to read them from
+ */
+IAITO_EXPORT QList<SectionDescription> sections(RCore *core, bool *ok);
+
+}
+
+#endif // NATIVEDESCRIPTIONS_H
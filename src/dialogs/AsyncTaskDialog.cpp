@@ -1,6 +1,7 @@
 
 #include "AsyncTaskDialog.h"
 #include "common/AsyncTask.h"
+#include "core/Iaito.h"
 
 #include "ui_AsyncTaskDialog.h"
 
@@ -24,12 +25,19 @@ AsyncTaskDialog::AsyncTaskDialog(AsyncTask::Ptr task, QWidget *parent)
 
     updateLog(task->getLog());
 
+    connect(task.data(), &AsyncTask::progressChanged, this, &AsyncTaskDialog::updateProgress);
+    updateProgress(task->getProgress());
+
+    connect(Core()->getAsyncTaskManager(), &AsyncTaskManager::tasksChanged, this,
+            &AsyncTaskDialog::updateQueueStats);
+
     connect(&timer, &QTimer::timeout, this, &AsyncTaskDialog::updateProgressTimer);
     timer.setInterval(1000);
     timer.setSingleShot(false);
     timer.start();
 
     updateProgressTimer();
+    updateQueueStats();
 }
 
 AsyncTaskDialog::~AsyncTaskDialog()
@@ -57,7 +65,53 @@ void AsyncTaskDialog::updateProgressTimer()
         label += " ";
     }
     label += tr("%n seconds", "%n second", secondsElapsed % 60);
+
+    const qint64 remaining = task->getRemainingTime();
+    if (remaining >= 0) {
+        const int secondsRemaining = (remaining + 500) / 1000;
+        if (secondsRemaining >= 60) {
+            label += ", " + tr("about %n minute(s) left", "", (secondsRemaining + 30) / 60);
+        } else {
+            label += ", " + tr("about %n second(s) left", "", secondsRemaining);
+        }
+    }
+
+    const QString phase = task->getPhase();
+    if (!phase.isEmpty()) {
+        label += "\n" + phase;
+    }
     ui->timeLabel->setText(label);
+    updateQueueStats();
+}
+
+void AsyncTaskDialog::updateProgress(int percent)
+{
+    // A maximum of 0 keeps the bar busy for tasks that do not report progress
+    ui->progressBar->setMaximum(percent < 0 ? 0 : 100);
+    ui->progressBar->setValue(qMax(0, percent));
+    ui->progressBar->setTextVisible(percent >= 0);
+}
+
+void AsyncTaskDialog::updateQueueStats()
+{
+    const AsyncTaskManager::QueueStats stats = Core()->getAsyncTaskManager()->getQueueStats();
+    const QString names[AsyncTask::PriorityCount] = {
+        tr("Interactive"), tr("Refresh"), tr("Background")
+    };
+
+    QStringList classes;
+    for (int i = 0; i < AsyncTask::PriorityCount; i++) {
+        classes << tr("%1: %2/%3 running, %4 queued").arg(names[i]).arg(stats.running[i])
+                .arg(stats.limit[i]).arg(stats.pending[i]);
+    }
+    QString label = classes.join("\n") + "\n";
+    label += tr("%1 finished, %2 coalesced, %3 superseded, average wait %4 ms")
+             .arg(stats.finished).arg(stats.coalesced).arg(stats.superseded)
+             .arg(stats.averageWaitMs);
+    if (stats.oldestPendingMs) {
+        label += "\n" + tr("Oldest queued task waiting for %1 ms").arg(stats.oldestPendingMs);
+    }
+    ui->queueLabel->setText(label);
 }
 
 void AsyncTaskDialog::closeEvent(QCloseEvent *event)
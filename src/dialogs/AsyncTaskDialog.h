@@ -30,6 +30,8 @@ public slots:
 private slots:
     void updateLog(const QString &log);
     void updateProgressTimer();
+    void updateProgress(int percent);
+    void updateQueueStats();
 
 protected:
     void closeEvent(QCloseEvent *event) override;
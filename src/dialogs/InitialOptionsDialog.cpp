@@ -25,6 +25,7 @@ InitialOptionsDialog::InitialOptionsDialog(MainWindow *main):
     ui->setupUi(this);
     setWindowFlags(windowFlags() & (~Qt::WindowContextHelpButtonHint));
     ui->logoSvgWidget->load(Config()->getLogoFile());
+    ui->analysisCacheCheckBox->setChecked(Config()->getAnalysisCacheEnabled());
 
     // Fill the plugins combo
     asmPlugins = core->getRAsmPluginDescriptions();
@@ -273,6 +274,8 @@ void InitialOptionsDialog::setupAndStartAnalysis(/*int level, QList<QString> adv
         options.forceBinPlugin = pluginDesc.name;
     }
     options.demangle = ui->demangleCheckBox->isChecked();
+    options.useAnalysisCache = ui->analysisCacheCheckBox->isChecked();
+    Config()->setAnalysisCacheEnabled(options.useAnalysisCache);
     if (ui->pdbCheckBox->isChecked()) {
         options.pdbFile = ui->pdbLineEdit->text();
     }
@@ -305,11 +308,19 @@ void InitialOptionsDialog::setupAndStartAnalysis(/*int level, QList<QString> adv
 
     MainWindow *main = this->main;
     connect(analTask, &AnalTask::openFileFailed, main, &MainWindow::openNewFileFailed);
+    // Show the file as soon as it is loaded, the analysis passes publish their results as they go
+    connect(analTask, &AnalTask::fileLoaded, main, &MainWindow::finalizeOpen);
     connect(analTask, &AsyncTask::finished, main, [analTask, main]() {
         if (analTask->getOpenFileFailed()) {
             return;
         }
-        main->finalizeOpen();
+        // Empty unless there is something to resume
+        main->setInterruptedAnalysis(analTask->getRemainingPasses());
+        if (analTask->getFileLoaded()) {
+            main->refreshAll();
+        } else {
+            main->finalizeOpen();
+        }
     });
 
     AsyncTask::Ptr analTaskPtr(analTask);
@@ -129,15 +129,33 @@ void XrefsDialog::onToTreeWidgetItemSelectionChanged()
 
 void XrefsDialog::updatePreview(RVA addr)
 {
-    TempConfig tempConfig;
-    tempConfig.set("scr.html", true);
-    tempConfig.set("scr.color", COLOR_MODE_16M);
-    tempConfig.set("asm.lines", false);
-    tempConfig.set("asm.bytes", false);
-
-    // Use cmd because cmRaw cannot handle the output properly. Why?
-    QString disas = Core()->cmd("pd--20 @ " + QString::number(addr));
-    ui->previewTextEdit->document()->setHtml(disas);
+    static const int previewInstructions = 20;
+
+    QList<DisassemblyLine> lines;
+    {
+        TempConfig tempConfig;
+        tempConfig.set("scr.color", COLOR_MODE_16M);
+        tempConfig.set("asm.lines", false);
+        tempConfig.set("asm.bytes", false);
+
+        // Goes through the disassembly cache, so walking over the xrefs does not decode
+        // the same instructions over and over again
+        RVA start = Core()->prevOpAddr(addr, previewInstructions);
+        lines = Core()->disassembleLines(start, previewInstructions * 4);
+    }
+
+    QStringList disas;
+    int instructionsAfter = 0;
+    RVA lastOffset = RVA_INVALID;
+    for (const DisassemblyLine &line : lines) {
+        if (line.offset > addr && line.offset != lastOffset
+                && ++instructionsAfter > previewInstructions) {
+            break;
+        }
+        lastOffset = line.offset;
+        disas << line.text;
+    }
+    ui->previewTextEdit->document()->setHtml(disas.join(QStringLiteral("<br>")));
 
     // Does it make any sense?
     ui->previewTextEdit->find(normalizeAddr(RAddressString(addr)), QTextDocument::FindBackward);
@@ -0,0 +1,185 @@
+#include "common/AnalysisSnapshot.h"
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+
+#include <algorithm>
+
+/**
+ * @brief Stores the analysis of a core with AnalysisSnapshot and loads it into a fresh
+ * core opening the same file, as AnalysisCache does, then compares what both list.
+ *
+ * Runs on the test executable itself, set IAITO_BENCHMARK_FILE to use another binary.
+ */
+class AnalysisSnapshotTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void functionsMatch();
+    void variablesMatch();
+    void metadataMatch_data();
+    void metadataMatch();
+    void readRejectsGarbage();
+
+private:
+    QByteArray path;
+    RCore *analyzed = nullptr;
+    RCore *loaded = nullptr;
+
+    RCore *openFile();
+};
+
+static QByteArray cmd(RCore *core, const QByteArray &command)
+{
+    char *res = r_core_cmd_str(core, command.constData());
+    QByteArray result(res);
+    free(res);
+    return result;
+}
+
+/**
+ * @brief Output of \a command with its lines sorted, items at the same address may be
+ * listed in another order once loaded
+ */
+static QList<QByteArray> sortedLines(RCore *core, const QByteArray &command)
+{
+    QList<QByteArray> lines = cmd(core, command).split('\n');
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+/**
+ * @brief "aflj" keyed by function address, so that the order functions were created in
+ * does not matter
+ */
+static QMap<RVA, QJsonObject> functions(RCore *core)
+{
+    QMap<RVA, QJsonObject> ret;
+    const QJsonArray array = QJsonDocument::fromJson(cmd(core, "aflj")).array();
+    for (const QJsonValue value : array) {
+        const QJsonObject object = value.toObject();
+        const QJsonValue addr = object.contains("addr") ? object["addr"] : object["offset"];
+        ret.insert(addr.toVariant().toULongLong(), object);
+    }
+    return ret;
+}
+
+RCore *AnalysisSnapshotTest::openFile()
+{
+    RCore *core = r_core_new();
+    if (!core) {
+        return nullptr;
+    }
+    r_config_set_i(core->config, "scr.color", 0);
+    r_config_set_i(core->config, "scr.interactive", 0);
+    if (!r_core_file_open(core, path.constData(), R_PERM_R, 0)
+            || !r_core_bin_load(core, path.constData(), UT64_MAX)) {
+        r_core_free(core);
+        return nullptr;
+    }
+    return core;
+}
+
+void AnalysisSnapshotTest::initTestCase()
+{
+    QString file = QString::fromLocal8Bit(qgetenv("IAITO_BENCHMARK_FILE"));
+    if (file.isEmpty()) {
+        file = QCoreApplication::applicationFilePath();
+    }
+    path = file.toUtf8();
+
+    r_cons_new();
+    analyzed = openFile();
+    QVERIFY(analyzed);
+    r_core_cmd0(analyzed, "aa");
+    QVERIFY(!functions(analyzed).isEmpty());
+
+    // Everything the r2 script dump used to miss
+    RAnalFunction *fcn = reinterpret_cast<RAnalFunction *>(r_list_first(analyzed->anal->fcns));
+    QVERIFY(fcn);
+    QVERIFY(r_anal_function_set_var(fcn, -8, R_ANAL_VAR_KIND_BPV, "int", 4, false, "iaito_local"));
+    QVERIFY(r_anal_function_set_var(fcn, 16, R_ANAL_VAR_KIND_BPV, "char *", 8, true, "iaito_arg"));
+    r_core_cmd0(analyzed, "\"td struct iaito_snapshot { int a; char b; };\"");
+    QVERIFY(r_anal_noreturn_add(analyzed->anal, "iaito_abort", UT64_MAX));
+    QCOMPARE(r_anal_class_create(analyzed->anal, "IaitoSnapshot"), R_ANAL_CLASS_ERR_SUCCESS);
+    r_meta_set_string(analyzed->anal, R_META_TYPE_COMMENT, fcn->addr, "iaito comment");
+
+    QTemporaryFile snapshot;
+    QVERIFY(snapshot.open());
+    QVERIFY(AnalysisSnapshot::write(analyzed, snapshot));
+    snapshot.close();
+    QFile written(snapshot.fileName());
+    QVERIFY(written.open(QIODevice::ReadOnly));
+    const QByteArray data = written.readAll();
+    QVERIFY(!data.isEmpty());
+
+    loaded = openFile();
+    QVERIFY(loaded);
+    QVERIFY(AnalysisSnapshot::read(loaded, data));
+}
+
+void AnalysisSnapshotTest::cleanupTestCase()
+{
+    r_core_free(loaded);
+    r_core_free(analyzed);
+}
+
+void AnalysisSnapshotTest::functionsMatch()
+{
+    QCOMPARE(functions(loaded), functions(analyzed));
+}
+
+void AnalysisSnapshotTest::variablesMatch()
+{
+    const QList<RVA> addresses = functions(analyzed).keys();
+    for (RVA addr : addresses) {
+        const QByteArray command = "afvj @ " + QByteArray::number(addr);
+        QCOMPARE(QJsonDocument::fromJson(cmd(loaded, command)), QJsonDocument::fromJson(cmd(analyzed, command)));
+    }
+    const RVA first = reinterpret_cast<RAnalFunction *>(r_list_first(analyzed->anal->fcns))->addr;
+    const QByteArray vars = cmd(loaded, "afv @ " + QByteArray::number(first));
+    QVERIFY(vars.contains("iaito_local"));
+    QVERIFY(vars.contains("iaito_arg"));
+}
+
+void AnalysisSnapshotTest::metadataMatch_data()
+{
+    QTest::addColumn<QByteArray>("command");
+    QTest::addColumn<QByteArray>("added");
+
+    QTest::newRow("flags") << QByteArray("f") << QByteArray();
+    QTest::newRow("xrefs") << QByteArray("ax") << QByteArray();
+    QTest::newRow("comments") << QByteArray("CC") << QByteArray("iaito comment");
+    QTest::newRow("types") << QByteArray("ts") << QByteArray("iaito_snapshot");
+    QTest::newRow("noreturn") << QByteArray("tn") << QByteArray("iaito_abort");
+    QTest::newRow("classes") << QByteArray("acl") << QByteArray("IaitoSnapshot");
+    QTest::newRow("signatures") << QByteArray("z") << QByteArray();
+}
+
+void AnalysisSnapshotTest::metadataMatch()
+{
+    QFETCH(QByteArray, command);
+    QFETCH(QByteArray, added);
+
+    QCOMPARE(sortedLines(loaded, command), sortedLines(analyzed, command));
+    QVERIFY(cmd(loaded, command).contains(added));
+}
+
+void AnalysisSnapshotTest::readRejectsGarbage()
+{
+    RCore *core = openFile();
+    QVERIFY(core);
+    QVERIFY(!AnalysisSnapshot::read(core, "not a snapshot\n"));
+    r_core_free(core);
+}
+
+QTEST_GUILESS_MAIN(AnalysisSnapshotTest)
+
+#include "AnalysisSnapshotTest.moc"
@@ -0,0 +1,8 @@
+TARGET = AnalysisSnapshotTest
+
+QT -= gui
+
+SOURCES += ../common/AnalysisSnapshot.cpp
+HEADERS += ../common/AnalysisSnapshot.h
+
+include(tests.pri)
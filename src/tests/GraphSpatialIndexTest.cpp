@@ -0,0 +1,260 @@
+#include "widgets/GraphSpatialIndex.h"
+
+#include <QtTest>
+
+#include <algorithm>
+#include <random>
+
+class GraphSpatialIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void blocksMatchLinearScan();
+    void edgesMatchLinearScan();
+    void straightEdges();
+    void reportedOnce();
+    void benchmarkBuild();
+    void benchmarkHover();
+    void benchmarkHoverLinearScan();
+};
+
+/**
+ * @brief Inclusive overlap, so that zero width edge segments touch what they cross
+ */
+static bool touches(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom()
+           && b.top() <= a.bottom();
+}
+
+static QRectF segmentBounds(const QPointF &a, const QPointF &b)
+{
+    return QRectF(QPointF(std::min(a.x(), b.x()), std::min(a.y(), b.y())),
+                  QPointF(std::max(a.x(), b.x()), std::max(a.y(), b.y())));
+}
+
+/**
+ * @brief Grid of blocks of varying sizes, each one with an edge straight down and an
+ * edge routed around to the next column, like a laid out graph of \a columns * \a rows blocks
+ */
+static GraphLayout::Graph makeGraph(int columns, int rows)
+{
+    GraphLayout::Graph graph;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> size(40, 200);
+    const int spacing = 260;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            GraphLayout::GraphBlock block;
+            block.entry = ut64(row) * columns + column;
+            block.x = column * spacing;
+            block.y = row * spacing;
+            block.width = size(random);
+            block.height = size(random);
+            if (row + 1 < rows) {
+                GraphLayout::GraphEdge down(block.entry + columns);
+                const int x = block.x + block.width / 2;
+                down.polyline << QPointF(x, block.y + block.height) << QPointF(x, block.y + spacing);
+                block.edges.push_back(down);
+            }
+            if (column + 1 < columns && row + 1 < rows) {
+                GraphLayout::GraphEdge side(block.entry + columns + 1);
+                const int y = block.y + block.height + 10;
+                side.polyline << QPointF(block.x + 5, block.y + block.height)
+                              << QPointF(block.x + 5, y)
+                              << QPointF(block.x + spacing + 5, y)
+                              << QPointF(block.x + spacing + 5, block.y + spacing);
+                block.edges.push_back(side);
+            }
+            graph[block.entry] = block;
+        }
+    }
+    return graph;
+}
+
+static std::vector<ut64> blocksLinear(const GraphLayout::Graph &graph, const QRectF &area)
+{
+    std::vector<ut64> result;
+    for (const auto &it : graph) {
+        const GraphLayout::GraphBlock &block = it.second;
+        if (touches(QRectF(block.x, block.y, block.width, block.height), area)) {
+            result.push_back(it.first);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::vector<GraphSpatialIndex::EdgeRef> edgesLinear(const GraphLayout::Graph &graph,
+                                                           const QRectF &area)
+{
+    std::vector<GraphSpatialIndex::EdgeRef> result;
+    for (const auto &it : graph) {
+        const std::vector<GraphLayout::GraphEdge> &edges = it.second.edges;
+        for (size_t i = 0; i < edges.size(); i++) {
+            const QPolygonF &polyline = edges[i].polyline;
+            for (int point = 0; point + 1 < polyline.size(); point++) {
+                if (touches(segmentBounds(polyline[point], polyline[point + 1]), area)) {
+                    result.emplace_back(it.first, i);
+                    break;
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * @brief Whether every element of \a subset is in the sorted \a candidates
+ */
+template<typename T>
+static bool containsAll(const std::vector<T> &candidates, const std::vector<T> &subset)
+{
+    return std::includes(candidates.begin(), candidates.end(), subset.begin(), subset.end());
+}
+
+static std::vector<QRectF> randomAreas(int count, qreal maxSize, qreal extent)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<qreal> position(-100, extent);
+    std::uniform_real_distribution<qreal> size(0, maxSize);
+    std::vector<QRectF> areas;
+    for (int i = 0; i < count; i++) {
+        areas.emplace_back(position(random), position(random), size(random), size(random));
+    }
+    return areas;
+}
+
+void GraphSpatialIndexTest::empty()
+{
+    GraphSpatialIndex index;
+    QVERIFY(index.blocksIn(QRectF(0, 0, 100, 100)).empty());
+    index.build(GraphLayout::Graph());
+    QVERIFY(index.blocksIn(QRectF(0, 0, 100, 100)).empty());
+    QVERIFY(index.edgesIn(QRectF(0, 0, 100, 100)).empty());
+}
+
+void GraphSpatialIndexTest::blocksMatchLinearScan()
+{
+    const GraphLayout::Graph graph = makeGraph(20, 15);
+    GraphSpatialIndex index;
+    index.build(graph);
+    for (const QRectF &area : randomAreas(500, 600, 20 * 260)) {
+        std::vector<ut64> found = index.blocksIn(area);
+        std::sort(found.begin(), found.end());
+        QVERIFY(containsAll(found, blocksLinear(graph, area)));
+    }
+    QVERIFY(index.blocksIn(QRectF(-1000, -1000, 10, 10)).empty());
+}
+
+void GraphSpatialIndexTest::edgesMatchLinearScan()
+{
+    const GraphLayout::Graph graph = makeGraph(20, 15);
+    GraphSpatialIndex index;
+    index.build(graph);
+    for (const QRectF &area : randomAreas(500, 600, 20 * 260)) {
+        const std::vector<GraphSpatialIndex::EdgeRef> found = index.edgesIn(area);
+        QVERIFY(std::is_sorted(found.begin(), found.end()));
+        QVERIFY(containsAll(found, edgesLinear(graph, area)));
+    }
+}
+
+void GraphSpatialIndexTest::straightEdges()
+{
+    // A vertical and a horizontal edge, both with zero width bounding boxes
+    GraphLayout::Graph graph;
+    GraphLayout::GraphBlock top;
+    top.entry = 1;
+    top.width = top.height = 100;
+    GraphLayout::GraphEdge vertical(2);
+    vertical.polyline << QPointF(50, 100) << QPointF(50, 2000);
+    top.edges.push_back(vertical);
+    GraphLayout::GraphEdge horizontal(3);
+    horizontal.polyline << QPointF(100, 50) << QPointF(2000, 50);
+    top.edges.push_back(horizontal);
+    graph[top.entry] = top;
+    GraphLayout::GraphBlock bottom;
+    bottom.entry = 2;
+    bottom.y = 2000;
+    bottom.width = bottom.height = 100;
+    graph[bottom.entry] = bottom;
+    GraphLayout::GraphBlock right;
+    right.entry = 3;
+    right.x = 2000;
+    right.width = right.height = 100;
+    graph[right.entry] = right;
+
+    GraphSpatialIndex index;
+    index.build(graph);
+    const std::vector<GraphSpatialIndex::EdgeRef> expectVertical = { { 1, 0 } };
+    const std::vector<GraphSpatialIndex::EdgeRef> expectHorizontal = { { 1, 1 } };
+    QCOMPARE(index.edgesIn(QRectF(49, 1000, 2, 2)), expectVertical);
+    QCOMPARE(index.edgesIn(QRectF(1000, 49, 2, 2)), expectHorizontal);
+    // Exactly on the line, with a zero sized area as well
+    QCOMPARE(index.edgesIn(QRectF(50, 1500, 0, 0)), expectVertical);
+    QCOMPARE(index.edgesIn(QRectF(1500, 50, 0, 0)), expectHorizontal);
+    // Near the lines, but in cells they do not cross
+    QVERIFY(index.edgesIn(QRectF(1000, 1000, 10, 10)).empty());
+}
+
+void GraphSpatialIndexTest::reportedOnce()
+{
+    const GraphLayout::Graph graph = makeGraph(10, 10);
+    GraphSpatialIndex index;
+    index.build(graph);
+    const QRectF everything(-10, -10, 10 * 260 + 20, 10 * 260 + 20);
+
+    std::vector<ut64> blocks = index.blocksIn(everything);
+    QCOMPARE(blocks.size(), graph.size());
+    std::sort(blocks.begin(), blocks.end());
+    QVERIFY(std::adjacent_find(blocks.begin(), blocks.end()) == blocks.end());
+
+    const std::vector<GraphSpatialIndex::EdgeRef> edges = index.edgesIn(everything);
+    QCOMPARE(edges, edgesLinear(graph, everything));
+}
+
+void GraphSpatialIndexTest::benchmarkBuild()
+{
+    const GraphLayout::Graph graph = makeGraph(120, 100);
+    GraphSpatialIndex index;
+    QBENCHMARK {
+        index.build(graph);
+    }
+}
+
+void GraphSpatialIndexTest::benchmarkHover()
+{
+    // What a mouse move over a graph of 12000 blocks queries, see GraphView::getBlockContaining()
+    const GraphLayout::Graph graph = makeGraph(120, 100);
+    GraphSpatialIndex index;
+    index.build(graph);
+    const std::vector<QRectF> areas = randomAreas(1000, 16, 120 * 260);
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QRectF &area : areas) {
+            found += index.blocksIn(area).size() + index.edgesIn(area).size();
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void GraphSpatialIndexTest::benchmarkHoverLinearScan()
+{
+    // Baseline of walking every block and edge, as done before the index
+    const GraphLayout::Graph graph = makeGraph(120, 100);
+    const std::vector<QRectF> areas = randomAreas(1000, 16, 120 * 260);
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QRectF &area : areas) {
+            found += blocksLinear(graph, area).size() + edgesLinear(graph, area).size();
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_APPLESS_MAIN(GraphSpatialIndexTest)
+
+#include "GraphSpatialIndexTest.moc"
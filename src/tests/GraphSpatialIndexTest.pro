@@ -0,0 +1,8 @@
+TARGET = GraphSpatialIndexTest
+
+QT += gui
+
+SOURCES += ../widgets/GraphSpatialIndex.cpp
+HEADERS += ../widgets/GraphSpatialIndex.h ../widgets/GraphLayout.h
+
+include(tests.pri)
@@ -0,0 +1,265 @@
+#include "widgets/HexGlyphAtlas.h"
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QImage>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+class HexGlyphAtlasTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void fragmentsInsidePixmap_data();
+    void fragmentsInsidePixmap();
+    void pixmapPerColor();
+    void sameInkAsDrawText();
+    void benchmarkScroll4K_data();
+    void benchmarkScroll4K();
+
+private:
+    QFont font;
+    qreal charWidth = 0;
+    qreal lineHeight = 0;
+};
+
+static bool isPrintable(uint8_t byte)
+{
+    return byte >= ' ' && byte <= '~';
+}
+
+/**
+ * @brief Same colors as HexWidget::itemColor()
+ */
+static QColor byteColor(uint8_t byte)
+{
+    if (byte == 0x00) {
+        return QColor(Qt::darkGray);
+    } else if (byte == 0x7f) {
+        return QColor(Qt::darkRed);
+    } else if (byte == 0xff) {
+        return QColor(Qt::red);
+    } else if (isPrintable(byte)) {
+        return QColor(Qt::darkGreen);
+    }
+    return QColor(Qt::black);
+}
+
+/**
+ * @brief Bounding box of the pixels drawn into a transparent \a image
+ */
+static QRect inkBounds(const QImage &image)
+{
+    QRect bounds;
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            if (qAlpha(image.pixel(x, y)) > 64) {
+                bounds |= QRect(x, y, 1, 1);
+            }
+        }
+    }
+    return bounds;
+}
+
+void HexGlyphAtlasTest::initTestCase()
+{
+    font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPointSize(10);
+    QFontMetricsF fontMetrics(font);
+    lineHeight = fontMetrics.height();
+    charWidth = fontMetrics.width(QLatin1Char('F'));
+    QVERIFY(charWidth > 0);
+}
+
+void HexGlyphAtlasTest::fragmentsInsidePixmap_data()
+{
+    QTest::addColumn<qreal>("devicePixelRatio");
+    QTest::newRow("1x") << qreal(1);
+    QTest::newRow("2x") << qreal(2);
+}
+
+void HexGlyphAtlasTest::fragmentsInsidePixmap()
+{
+    QFETCH(qreal, devicePixelRatio);
+    HexGlyphAtlas atlas;
+    atlas.setup(font, charWidth, lineHeight, devicePixelRatio);
+    const QPixmap &pixmap = atlas.pixmap(Qt::black);
+    const QRectF pixmapRect(QPointF(0, 0), QSizeF(pixmap.size()));
+    const QPointF pos(10, 20);
+
+    QVector<QRectF> sources;
+    for (int byte = 0; byte <= 0xff; byte++) {
+        for (bool ascii : { false, true }) {
+            const QPainter::PixmapFragment f = ascii ? atlas.ascii(byte, pos) : atlas.hexPair(byte, pos);
+            const QRectF source(f.sourceLeft, f.sourceTop, f.width, f.height);
+            QVERIFY(pixmapRect.contains(source));
+            for (const QRectF &other : sources) {
+                QVERIFY(!other.intersects(source));
+            }
+            sources.append(source);
+
+            // Drawn at logical size with its top left corner on pos
+            const qreal width = ascii ? charWidth : 2 * charWidth;
+            QCOMPARE(f.width * f.scaleX, width);
+            QCOMPARE(f.height * f.scaleY, lineHeight);
+            QCOMPARE(f.x - width / 2, pos.x());
+            QCOMPARE(f.y - lineHeight / 2, pos.y());
+        }
+    }
+}
+
+void HexGlyphAtlasTest::pixmapPerColor()
+{
+    HexGlyphAtlas atlas;
+    atlas.setup(font, charWidth, lineHeight, 1);
+    const qint64 red = atlas.pixmap(Qt::red).cacheKey();
+    QVERIFY(atlas.pixmap(Qt::blue).cacheKey() != red);
+    QCOMPARE(atlas.pixmap(Qt::red).cacheKey(), red);
+
+    atlas.setup(font, charWidth, lineHeight, 1);
+    QCOMPARE(atlas.pixmap(Qt::red).cacheKey(), red);
+
+    atlas.setup(font, charWidth, lineHeight, 2);
+    QVERIFY(atlas.pixmap(Qt::red).cacheKey() != red);
+}
+
+void HexGlyphAtlasTest::sameInkAsDrawText()
+{
+    HexGlyphAtlas atlas;
+    atlas.setup(font, charWidth, lineHeight, 1);
+    const QSize size(std::ceil(2 * charWidth) + 4, std::ceil(lineHeight) + 4);
+
+    for (uint8_t byte : { 0x00, 0x41, 0xa5, 0xff }) {
+        QImage text(size, QImage::Format_ARGB32_Premultiplied);
+        text.fill(Qt::transparent);
+        QPainter painter(&text);
+        painter.setFont(font);
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(2, 2, 2 * charWidth, lineHeight), Qt::AlignVCenter,
+                         QString("%1").arg(byte, 2, 16, QLatin1Char('0')));
+        painter.end();
+
+        QImage glyphs(size, QImage::Format_ARGB32_Premultiplied);
+        glyphs.fill(Qt::transparent);
+        painter.begin(&glyphs);
+        const QPainter::PixmapFragment fragment = atlas.hexPair(byte, QPointF(2, 2));
+        painter.drawPixmapFragments(&fragment, 1, atlas.pixmap(Qt::black));
+        painter.end();
+
+        const QRect expected = inkBounds(text);
+        const QRect actual = inkBounds(glyphs);
+        QVERIFY(!expected.isEmpty());
+        QVERIFY2(std::abs(actual.left() - expected.left()) <= 1
+                 && std::abs(actual.top() - expected.top()) <= 1
+                 && std::abs(actual.right() - expected.right()) <= 1
+                 && std::abs(actual.bottom() - expected.bottom()) <= 1,
+                 qPrintable(QString("byte %1").arg(byte)));
+    }
+}
+
+void HexGlyphAtlasTest::benchmarkScroll4K_data()
+{
+    QTest::addColumn<bool>("useAtlas");
+    QTest::newRow("atlas") << true;
+    QTest::newRow("drawText") << false;
+}
+
+void HexGlyphAtlasTest::benchmarkScroll4K()
+{
+    // Scrolls a hexdump filling a 3840x2160 viewport one line per frame, drawing
+    // the hex items and ASCII the way HexWidget::drawItemArea() and
+    // HexWidget::drawAsciiArea() do, with the glyph atlas or with a drawText()
+    // call per item as before it
+    QFETCH(bool, useAtlas);
+    const QSize viewport(3840, 2160);
+    const int visibleLines = static_cast<int>(std::ceil(viewport.height() / lineHeight));
+    // Address column, then 3 characters per hex item and 1 per ASCII character
+    const qreal hexLeft = 18 * charWidth;
+    const int rowBytes = static_cast<int>((viewport.width() - hexLeft) / (4 * charWidth)) & ~0xf;
+    QVERIFY(rowBytes > 0);
+
+    QByteArray data(16 * 1024 * 1024, Qt::Uninitialized);
+    std::mt19937 random(42);
+    for (char &byte : data) {
+        // Mostly small values and text, like code and data sections
+        const unsigned value = random() % 512;
+        byte = static_cast<char>(value < 256 ? value : value % 128);
+    }
+    const int maxLine = data.size() / rowBytes - visibleLines;
+
+    QImage image(viewport, QImage::Format_ARGB32_Premultiplied);
+    HexGlyphAtlas atlas;
+    atlas.setup(font, charWidth, lineHeight, 1);
+
+    auto paintFrame = [&](int firstLine) {
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        painter.setFont(font);
+        QHash<QRgb, QVector<QPainter::PixmapFragment>> fragments;
+        const qreal asciiLeft = hexLeft + rowBytes * 3 * charWidth + charWidth;
+        for (int line = 0; line < visibleLines; line++) {
+            const qreal y = line * lineHeight;
+            const char *row = data.constData() + static_cast<qint64>(firstLine + line) * rowBytes;
+            for (int i = 0; i < rowBytes; i++) {
+                const uint8_t byte = static_cast<uint8_t>(row[i]);
+                const QColor color = byteColor(byte);
+                const QRectF item(hexLeft + i * 3 * charWidth, y, 2 * charWidth, lineHeight);
+                const QRectF ascii(asciiLeft + i * charWidth, y, charWidth, lineHeight);
+                if (useAtlas) {
+                    auto &colorFragments = fragments[color.rgba()];
+                    colorFragments.append(atlas.hexPair(byte, item.topLeft()));
+                    if (isPrintable(byte)) {
+                        colorFragments.append(atlas.ascii(byte, ascii.topLeft()));
+                    }
+                } else {
+                    painter.setPen(color);
+                    painter.drawText(item, Qt::AlignVCenter, QString("%1").arg(byte, 2, 16, QLatin1Char('0')));
+                    if (isPrintable(byte)) {
+                        painter.drawText(ascii, Qt::AlignVCenter, QString(QChar(byte)));
+                    }
+                }
+                if (!isPrintable(byte)) {
+                    const qreal a = 2;
+                    painter.fillRect(QRectF(ascii.left() + (charWidth - a) / 2, ascii.bottom() - 2 * a, a, a),
+                                     color);
+                }
+            }
+        }
+        for (auto it = fragments.constBegin(); it != fragments.constEnd(); ++it) {
+            painter.drawPixmapFragments(it.value().constData(), it.value().size(),
+                                        atlas.pixmap(QColor::fromRgba(it.key())));
+        }
+    };
+
+    // Renders the atlas pixmaps outside of the measurement
+    paintFrame(0);
+
+    const int frames = 60;
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 1; frame <= frames; frame++) {
+        paintFrame(frame % maxLine);
+    }
+    const qint64 elapsed = std::max<qint64>(timer.nsecsElapsed(), 1);
+    QTest::setBenchmarkResult(frames * 1e9 / elapsed, QTest::FramesPerSecond);
+}
+
+int main(int argc, char *argv[])
+{
+    // Everything is painted into images, so no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    HexGlyphAtlasTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "HexGlyphAtlasTest.moc"
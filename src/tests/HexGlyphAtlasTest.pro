@@ -0,0 +1,8 @@
+TARGET = HexGlyphAtlasTest
+
+QT += gui
+
+SOURCES += ../widgets/HexGlyphAtlas.cpp
+HEADERS += ../widgets/HexGlyphAtlas.h
+
+include(tests.pri)
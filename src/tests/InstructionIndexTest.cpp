@@ -0,0 +1,126 @@
+#include "common/InstructionIndex.h"
+
+#include <QtTest>
+
+class InstructionIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stepForward();
+    void stepBackFromRunEnd();
+    void stepBackFromRunEndTooFar();
+    void insertOverlapping();
+    void insertTouching();
+    void insertTouchingBefore();
+    void insertContained();
+    void insertDisagreeingStart();
+    void insertDisagreeingEnd();
+};
+
+static InstructionIndex::Run makeRun(const QVector<RVA> &starts, RVA end)
+{
+    InstructionIndex::Run run;
+    run.starts = starts;
+    run.end = end;
+    return run;
+}
+
+void InstructionIndexTest::stepForward()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x105 }, 0x108));
+    QCOMPARE(index.step(0x100, 2), RVA(0x105));
+    QCOMPARE(index.step(0x102, 2), RVA(0x108));
+    QCOMPARE(index.step(0x102, 3), RVA_INVALID);
+}
+
+void InstructionIndexTest::stepBackFromRunEnd()
+{
+    // What decoding backwards from 0x108 leaves in the index
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x105 }, 0x108));
+    QCOMPARE(index.step(0x108, -1), RVA(0x105));
+    QCOMPARE(index.step(0x108, -3), RVA(0x100));
+}
+
+void InstructionIndexTest::stepBackFromRunEndTooFar()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x105 }, 0x108));
+    QCOMPARE(index.step(0x108, -4), RVA_INVALID);
+    // Only backwards, nothing is known after the end
+    QCOMPARE(index.step(0x108, 1), RVA_INVALID);
+    QCOMPARE(index.step(0x109, -1), RVA_INVALID);
+}
+
+void InstructionIndexTest::insertOverlapping()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x105 }, 0x108));
+    index.insert(makeRun({ 0x105, 0x108, 0x10a }, 0x10c));
+    QCOMPARE(index.runStart(0x10a), RVA(0x100));
+    QCOMPARE(index.step(0x100, 4), RVA(0x10a));
+    QCOMPARE(index.step(0x10c, -5), RVA(0x100));
+}
+
+void InstructionIndexTest::insertTouching()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x104 }, 0x108));
+    index.insert(makeRun({ 0x108, 0x10c }, 0x110));
+    QCOMPARE(index.runStart(0x10c), RVA(0x100));
+    QCOMPARE(index.step(0x104, 2), RVA(0x10c));
+}
+
+void InstructionIndexTest::insertTouchingBefore()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x108, 0x10c }, 0x110));
+    index.insert(makeRun({ 0x100, 0x104 }, 0x108));
+    QCOMPARE(index.runStart(0x10c), RVA(0x100));
+    QCOMPARE(index.step(0x10c, -3), RVA(0x100));
+}
+
+void InstructionIndexTest::insertContained()
+{
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x105, 0x108 }, 0x10a));
+    index.insert(makeRun({ 0x102, 0x105 }, 0x108));
+    QCOMPARE(index.runStart(0x109), RVA(0x100));
+    QCOMPARE(index.step(0x100, 4), RVA(0x10a));
+}
+
+void InstructionIndexTest::insertDisagreeingStart()
+{
+    // The newer run starts in the middle of the instruction at 0x104
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x102, 0x104 }, 0x108));
+    index.insert(makeRun({ 0x105, 0x106 }, 0x10a));
+    QVERIFY(!index.isBoundary(0x104));
+    QCOMPARE(index.runStart(0x106), RVA(0x105));
+    QCOMPARE(index.step(0x105, 2), RVA(0x10a));
+    QCOMPARE(index.step(0x105, -1), RVA_INVALID);
+    // What ends before the newer run remains, without claiming to reach it
+    QCOMPARE(index.runStart(0x100), RVA(0x100));
+    QCOMPARE(index.step(0x100, 2), RVA(0x104));
+    QCOMPARE(index.step(0x100, 3), RVA_INVALID);
+}
+
+void InstructionIndexTest::insertDisagreeingEnd()
+{
+    // The newer run ends in the middle of the instruction at 0x104
+    InstructionIndex index;
+    index.insert(makeRun({ 0x100, 0x104, 0x108, 0x10c }, 0x110));
+    index.insert(makeRun({ 0x100, 0x103 }, 0x106));
+    QVERIFY(!index.isBoundary(0x104));
+    QCOMPARE(index.step(0x100, 2), RVA(0x106));
+    QCOMPARE(index.step(0x100, 3), RVA_INVALID);
+    QCOMPARE(index.runStart(0x10c), RVA(0x108));
+    QCOMPARE(index.step(0x108, 2), RVA(0x110));
+    QCOMPARE(index.step(0x108, -1), RVA_INVALID);
+}
+
+QTEST_APPLESS_MAIN(InstructionIndexTest)
+
+#include "InstructionIndexTest.moc"
@@ -0,0 +1,8 @@
+TARGET = InstructionIndexTest
+
+QT -= gui
+
+SOURCES += ../common/InstructionIndex.cpp
+HEADERS += ../common/InstructionIndex.h
+
+include(tests.pri)
@@ -0,0 +1,263 @@
+#include "core/NativeDescriptions.h"
+#include "common/JsonStream.h"
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+/**
+ * @brief Compares the lists read from the r2 structures with the JSON output they replace,
+ * and benchmarks both.
+ *
+ * Runs on the test executable itself, set IAITO_BENCHMARK_FILE to use another binary,
+ * e.g. a large firmware image.
+ */
+class NativeDescriptionsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void flagsMatchJson();
+    void sectionsMatchJson();
+    void stringsMatchJson();
+    void entropyHonorsHashLimit();
+
+    void benchmarkFlagsNative();
+    void benchmarkFlagsJson();
+    void benchmarkSectionsNative();
+    void benchmarkSectionsJson();
+    void benchmarkStringsNative();
+    void benchmarkStringsJson();
+
+private:
+    RCore *core = nullptr;
+
+    QByteArray cmd(const char *command);
+    QList<FlagDescription> flagsJson();
+    QList<SectionDescription> sectionsJson();
+    QList<StringDescription> stringsJson();
+};
+
+// Like the large firmware images the native lists were written for
+static const int SYNTHETIC_FLAGS = 200000;
+
+QByteArray NativeDescriptionsTest::cmd(const char *command)
+{
+    char *res = r_core_cmd_str(core, command);
+    QByteArray result(res);
+    free(res);
+    return result;
+}
+
+/**
+ * @brief What IaitoCore::getAllFlags did before, through "fj" and QJsonDocument
+ */
+QList<FlagDescription> NativeDescriptionsTest::flagsJson()
+{
+    QList<FlagDescription> ret;
+    const QJsonArray array = QJsonDocument::fromJson(cmd("fj")).array();
+    for (const QJsonValue value : array) {
+        const QJsonObject object = value.toObject();
+        FlagDescription flag;
+        flag.offset = object["offset"].toVariant().toULongLong();
+        flag.size = object["size"].toVariant().toULongLong();
+        flag.name = object["name"].toString();
+        flag.realname = object["realname"].toString();
+        ret << flag;
+    }
+    return ret;
+}
+
+/**
+ * @brief Same as IaitoCore::getAllSectionsJson()
+ */
+QList<SectionDescription> NativeDescriptionsTest::sectionsJson()
+{
+    QList<SectionDescription> ret;
+    const QJsonArray array = QJsonDocument::fromJson(cmd("iSj entropy")).object()["sections"].toArray();
+    for (const QJsonValue value : array) {
+        const QJsonObject object = value.toObject();
+        SectionDescription section;
+        section.name = object["name"].toString();
+        if (section.name.isEmpty()) {
+            continue;
+        }
+        section.vaddr = object["vaddr"].toVariant().toULongLong();
+        section.vsize = object["vsize"].toVariant().toULongLong();
+        section.paddr = object["paddr"].toVariant().toULongLong();
+        section.size = object["size"].toVariant().toULongLong();
+        section.perm = object["perm"].toString();
+        section.entropy = object["entropy"].toString();
+        ret << section;
+    }
+    return ret;
+}
+
+/**
+ * @brief Same as IaitoCore::getAllStringsJson()
+ */
+QList<StringDescription> NativeDescriptionsTest::stringsJson()
+{
+    QList<StringDescription> ret;
+    const QByteArray json = cmd("izzj");
+    JsonStream::forEachArrayElement(json.constData(), json.size(), [&ret](const char *begin, const char *end) {
+        JsonStreamObject object(begin, end);
+        StringDescription string;
+        string.string = object.toString("string");
+        string.vaddr = object.toULongLong("vaddr");
+        string.type = object.toString("type");
+        string.size = static_cast<ut32>(object.toULongLong("size"));
+        string.length = static_cast<ut32>(object.toULongLong("length"));
+        string.section = object.toString("section");
+        ret << string;
+        return true;
+    });
+    return ret;
+}
+
+void NativeDescriptionsTest::initTestCase()
+{
+    QString path = QString::fromLocal8Bit(qgetenv("IAITO_BENCHMARK_FILE"));
+    if (path.isEmpty()) {
+        path = QCoreApplication::applicationFilePath();
+    }
+    const QByteArray file = path.toUtf8();
+
+    r_cons_new();
+    core = r_core_new();
+    QVERIFY(core);
+    r_config_set_i(core->config, "scr.color", 0);
+    r_config_set_i(core->config, "scr.interactive", 0);
+    QVERIFY(r_core_file_open(core, file.constData(), R_PERM_R, 0));
+    QVERIFY(r_core_bin_load(core, file.constData(), UT64_MAX));
+
+    r_flag_space_set(core->flags, "benchmark");
+    for (int i = 0; i < SYNTHETIC_FLAGS; i++) {
+        const QByteArray name = "bench." + QByteArray::number(i);
+        r_flag_set(core->flags, name.constData(), 0x100000 + ut64(i) * 8, 4);
+    }
+    r_flag_space_set(core->flags, nullptr);
+}
+
+void NativeDescriptionsTest::cleanupTestCase()
+{
+    r_core_free(core);
+}
+
+void NativeDescriptionsTest::flagsMatchJson()
+{
+    const QList<FlagDescription> native = NativeDescriptions::flags(core, nullptr);
+    const QList<FlagDescription> json = flagsJson();
+    QVERIFY(native.size() >= SYNTHETIC_FLAGS);
+    QCOMPARE(native.size(), json.size());
+
+    QHash<QString, RVA> offsets;
+    for (const FlagDescription &flag : json) {
+        offsets.insert(flag.name, flag.offset);
+    }
+    for (const FlagDescription &flag : native) {
+        QVERIFY2(offsets.contains(flag.name), qPrintable(flag.name));
+        QCOMPARE(flag.offset, offsets.value(flag.name));
+    }
+
+    const RSpace *space = r_flag_space_get(core->flags, "benchmark");
+    QVERIFY(space);
+    QCOMPARE(NativeDescriptions::flags(core, space).size(), SYNTHETIC_FLAGS);
+}
+
+void NativeDescriptionsTest::sectionsMatchJson()
+{
+    bool ok;
+    const QList<SectionDescription> native = NativeDescriptions::sections(core, &ok);
+    QVERIFY(ok);
+    const QList<SectionDescription> json = sectionsJson();
+    QVERIFY(!native.isEmpty());
+    QCOMPARE(native.size(), json.size());
+    for (int i = 0; i < native.size(); i++) {
+        QCOMPARE(native[i].name, json[i].name);
+        QCOMPARE(native[i].vaddr, json[i].vaddr);
+        QCOMPARE(native[i].paddr, json[i].paddr);
+        QCOMPARE(native[i].size, json[i].size);
+        QCOMPARE(native[i].vsize, json[i].vsize);
+        QCOMPARE(native[i].entropy.isEmpty(), json[i].entropy.isEmpty());
+    }
+}
+
+void NativeDescriptionsTest::stringsMatchJson()
+{
+    bool ok;
+    const QList<StringDescription> native = NativeDescriptions::strings(core, &ok);
+    QVERIFY(ok);
+    const QList<StringDescription> json = stringsJson();
+    QCOMPARE(native.size(), json.size());
+    for (int i = 0; i < native.size(); i++) {
+        QCOMPARE(native[i].vaddr, json[i].vaddr);
+        QCOMPARE(native[i].string, json[i].string);
+        QCOMPARE(native[i].length, json[i].length);
+    }
+}
+
+void NativeDescriptionsTest::entropyHonorsHashLimit()
+{
+    const ut64 hashLimit = r_config_get_i(core->config, "bin.hashlimit");
+    r_config_set_i(core->config, "bin.hashlimit", 1);
+    bool ok;
+    const QList<SectionDescription> sections = NativeDescriptions::sections(core, &ok);
+    r_config_set_i(core->config, "bin.hashlimit", hashLimit);
+    QVERIFY(ok);
+    for (const SectionDescription &section : sections) {
+        QVERIFY2(section.entropy.isEmpty(), qPrintable(section.name));
+    }
+}
+
+void NativeDescriptionsTest::benchmarkFlagsNative()
+{
+    QBENCHMARK {
+        NativeDescriptions::flags(core, nullptr);
+    }
+}
+
+void NativeDescriptionsTest::benchmarkFlagsJson()
+{
+    QBENCHMARK {
+        flagsJson();
+    }
+}
+
+void NativeDescriptionsTest::benchmarkSectionsNative()
+{
+    bool ok;
+    QBENCHMARK {
+        NativeDescriptions::sections(core, &ok);
+    }
+}
+
+void NativeDescriptionsTest::benchmarkSectionsJson()
+{
+    QBENCHMARK {
+        sectionsJson();
+    }
+}
+
+void NativeDescriptionsTest::benchmarkStringsNative()
+{
+    bool ok;
+    QBENCHMARK {
+        NativeDescriptions::strings(core, &ok);
+    }
+}
+
+void NativeDescriptionsTest::benchmarkStringsJson()
+{
+    QBENCHMARK {
+        stringsJson();
+    }
+}
+
+QTEST_GUILESS_MAIN(NativeDescriptionsTest)
+
+#include "NativeDescriptionsTest.moc"
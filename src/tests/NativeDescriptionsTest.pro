@@ -0,0 +1,8 @@
+TARGET = NativeDescriptionsTest
+
+QT += gui
+
+SOURCES += ../core/NativeDescriptions.cpp ../common/JsonStream.cpp
+HEADERS += ../core/NativeDescriptions.h ../common/JsonStream.h
+
+include(tests.pri)
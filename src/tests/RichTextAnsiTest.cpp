@@ -0,0 +1,186 @@
+#include "common/RichTextPainter.h"
+
+#include <QtTest>
+
+class RichTextAnsiTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void plainText();
+    void basicColors();
+    void colors256();
+    void trueColor();
+    void resets();
+    void sameColorJoined();
+    void nonSgrSequences();
+    void htmlEscaping();
+    void htmlColors();
+    void benchmarkFromAnsi();
+    void benchmarkToHtml();
+};
+
+static const QString ESC = QStringLiteral("\x1b");
+
+/**
+ * @brief Lines in the format of colored pd output as printed by r2 with scr.color=3
+ */
+static QString coloredDisassembly(int lines)
+{
+    static const QStringList sample = {
+        ESC + "[38;2;19;161;14m0x00001139" + ESC + "[0m      " + ESC + "[38;2;193;156;0m55"
+            + ESC + "[0m             " + ESC + "[38;2;136;23;152mpush" + ESC + "[38;2;204;204;204m rbp"
+            + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x0000113a" + ESC + "[0m      " + ESC + "[38;2;193;156;0m4889e5"
+            + ESC + "[0m         " + ESC + "[38;2;204;204;204mmov rbp, rsp" + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x0000113d" + ESC + "[0m      " + ESC + "[38;2;193;156;0m488d3dc00e00."
+            + ESC + "[0m  " + ESC + "[38;2;204;204;204mlea rdi, " + ESC + "[38;2;58;150;221mstr.Hello"
+            + ESC + "[0m" + ESC + "[38;2;204;204;204m ; 0x2004" + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x00001144" + ESC + "[0m      " + ESC + "[38;2;193;156;0me8e7feffff"
+            + ESC + "[0m     " + ESC + "[1;38;2;19;161;14mcall" + ESC + "[38;2;204;204;204m sym.imp.puts"
+            + ESC + "[0m " + ESC + "[38;5;244m; int puts(const char *s)" + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x00001149" + ESC + "[0m      " + ESC + "[38;2;193;156;0mb800000000"
+            + ESC + "[0m     " + ESC + "[38;2;204;204;204mmov eax, " + ESC + "[33m0" + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x0000114e" + ESC + "[0m      " + ESC + "[38;2;193;156;0m5d"
+            + ESC + "[0m             " + ESC + "[38;2;136;23;152mpop" + ESC + "[38;2;204;204;204m rbp"
+            + ESC + "[0m",
+        ESC + "[38;2;19;161;14m0x0000114f" + ESC + "[0m      " + ESC + "[38;2;193;156;0mc3"
+            + ESC + "[0m             " + ESC + "[38;2;197;15;31mret" + ESC + "[0m",
+    };
+    QString text;
+    for (int i = 0; i < lines; i++) {
+        text += sample[i % sample.size()];
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+void RichTextAnsiTest::plainText()
+{
+    QString plain;
+    const RichTextPainter::List list = RichTextPainter::fromAnsi("mov eax, 1", &plain);
+    QCOMPARE(list.size(), size_t(1));
+    QCOMPARE(list[0].text, QString("mov eax, 1"));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagNone);
+    QCOMPARE(plain, QString("mov eax, 1"));
+}
+
+void RichTextAnsiTest::basicColors()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(ESC + "[31mred" + ESC + "[0m "
+                                                                 + ESC + "[92;44mgreen");
+    QCOMPARE(list.size(), size_t(3));
+    QCOMPARE(list[0].text, QString("red"));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagColor);
+    QCOMPARE(list[0].textColor, QColor(0xcd, 0, 0));
+    QCOMPARE(list[1].flags, RichTextPainter::FlagNone);
+    QCOMPARE(list[2].flags, RichTextPainter::FlagAll);
+    QCOMPARE(list[2].textColor, QColor(0, 0xff, 0));
+    QCOMPARE(list[2].textBackground, QColor(0, 0, 0xee));
+}
+
+void RichTextAnsiTest::colors256()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(ESC + "[38;5;196mcube"
+                                                                 + ESC + "[0;48;5;232mgray"
+                                                                 + ESC + "[38;5;9mbasic");
+    QCOMPARE(list.size(), size_t(3));
+    QCOMPARE(list[0].textColor, QColor(255, 0, 0));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagColor);
+    QCOMPARE(list[1].textBackground, QColor(8, 8, 8));
+    QCOMPARE(list[1].flags, RichTextPainter::FlagBackground);
+    QCOMPARE(list[2].textColor, QColor(0xff, 0, 0));
+    QCOMPARE(list[2].flags, RichTextPainter::FlagAll);
+}
+
+void RichTextAnsiTest::trueColor()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(ESC + "[38;2;10;20;30;48;2;40;50;60mx"
+                                                                 + ESC + "[38:2:300:0:0my");
+    QCOMPARE(list.size(), size_t(2));
+    QCOMPARE(list[0].textColor, QColor(10, 20, 30));
+    QCOMPARE(list[0].textBackground, QColor(40, 50, 60));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagAll);
+    // Out of range components are clamped, the background is kept
+    QCOMPARE(list[1].textColor, QColor(255, 0, 0));
+    QCOMPARE(list[1].textBackground, QColor(40, 50, 60));
+}
+
+void RichTextAnsiTest::resets()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(ESC + "[31;41ma" + ESC + "[39mb"
+                                                                 + ESC + "[49mc" + ESC + "[32;42md"
+                                                                 + ESC + "[me");
+    QCOMPARE(list.size(), size_t(5));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagAll);
+    QCOMPARE(list[1].flags, RichTextPainter::FlagBackground);
+    QCOMPARE(list[2].flags, RichTextPainter::FlagNone);
+    QCOMPARE(list[3].flags, RichTextPainter::FlagAll);
+    QCOMPARE(list[4].text, QString("e"));
+    QCOMPARE(list[4].flags, RichTextPainter::FlagNone);
+}
+
+void RichTextAnsiTest::sameColorJoined()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(ESC + "[31ma" + ESC + "[1;31mb"
+                                                                 + ESC + "[0m" + ESC + "[0mc");
+    QCOMPARE(list.size(), size_t(2));
+    QCOMPARE(list[0].text, QString("ab"));
+    QCOMPARE(list[1].text, QString("c"));
+}
+
+void RichTextAnsiTest::nonSgrSequences()
+{
+    QString plain;
+    // Hide cursor, erase line, cursor style with an intermediate byte, a private SGR lookalike
+    const RichTextPainter::List list = RichTextPainter::fromAnsi("a" + ESC + "[?25lb" + ESC + "[2Kc"
+                                                                 + ESC + "[2 qd" + ESC + "[>4;2me"
+                                                                 + ESC + "(Bf", &plain);
+    QCOMPARE(plain, QString("abcdef"));
+    QCOMPARE(list.size(), size_t(1));
+    QCOMPARE(list[0].flags, RichTextPainter::FlagNone);
+
+    // Unterminated at the end of the text
+    QCOMPARE(RichTextPainter::fromAnsi("x" + ESC + "[?25").size(), size_t(1));
+}
+
+void RichTextAnsiTest::htmlEscaping()
+{
+    const QString html = RichTextPainter::toHtml(RichTextPainter::fromAnsi("<a & \"b\">\r\nc"));
+    QCOMPARE(html, QString("&lt;a&nbsp;&amp;&nbsp;&quot;b&quot;&gt;<br />c"));
+}
+
+void RichTextAnsiTest::htmlColors()
+{
+    const QString html = RichTextPainter::toHtml(RichTextPainter::fromAnsi(
+                                                     ESC + "[31ma" + ESC + "[44mb" + ESC + "[39mc"
+                                                     + ESC + "[0md"));
+    QCOMPARE(html, QString("<span style=\"color:#cd0000\">a</span>"
+                           "<span style=\"color:#cd0000;background-color:#0000ee\">b</span>"
+                           "<span style=\"background-color:#0000ee\">c</span>"
+                           "d"));
+}
+
+void RichTextAnsiTest::benchmarkFromAnsi()
+{
+    const QString text = coloredDisassembly(5000);
+    size_t runs = 0;
+    QBENCHMARK {
+        runs = RichTextPainter::fromAnsi(text).size();
+    }
+    QVERIFY(runs > 0);
+}
+
+void RichTextAnsiTest::benchmarkToHtml()
+{
+    const RichTextPainter::List list = RichTextPainter::fromAnsi(coloredDisassembly(5000));
+    int size = 0;
+    QBENCHMARK {
+        size = RichTextPainter::toHtml(list).size();
+    }
+    QVERIFY(size > 0);
+}
+
+QTEST_APPLESS_MAIN(RichTextAnsiTest)
+
+#include "RichTextAnsiTest.moc"
@@ -0,0 +1,8 @@
+TARGET = RichTextAnsiTest
+
+QT += gui
+
+SOURCES += ../common/RichTextAnsi.cpp
+HEADERS += ../common/RichTextPainter.h
+
+include(tests.pri)
@@ -0,0 +1,14 @@
+# Settings shared by every test, see tests.pro
+
+TEMPLATE = app
+
+QT += testlib
+CONFIG += testcase c++11
+
+INCLUDEPATH += $$PWD/..
+# iaito sources are compiled in, not imported from the iaito binary
+DEFINES += IAITO_SOURCE_BUILD
+
+SOURCES += $${TARGET}.cpp
+
+include($$PWD/../lib_radare2.pri)
@@ -0,0 +1,12 @@
+# Unit tests and benchmarks, each one a QtTest executable built from the test
+# and the iaito sources it covers. CMake and meson builds add them as well.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    AnalysisSnapshotTest.pro \
+    GraphSpatialIndexTest.pro \
+    HexGlyphAtlasTest.pro \
+    InstructionIndexTest.pro \
+    NativeDescriptionsTest.pro \
+    RichTextAnsiTest.pro
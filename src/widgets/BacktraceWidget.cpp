@@ -4,6 +4,7 @@
 #include "QHeaderView"
 
 #include "core/MainWindow.h"
+#include "common/CommandProfiler.h"
 
 BacktraceWidget::BacktraceWidget(MainWindow *main) :
     IaitoDockWidget(main),
@@ -42,6 +43,8 @@ void BacktraceWidget::updateContents()
         return;
     }
 
+    CommandProfiler::Context profilerContext(objectName());
+
     setBacktraceGrid();
 }
 
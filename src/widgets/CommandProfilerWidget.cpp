@@ -0,0 +1,201 @@
+#include "CommandProfilerWidget.h"
+#include "common/CommandProfiler.h"
+#include "common/Configuration.h"
+#include "core/MainWindow.h"
+
+#include <QVBoxLayout>
+#include <QToolBar>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileDialog>
+#include <QMessageBox>
+
+namespace {
+
+enum Column {
+    ContextColumn = 0,
+    CommandColumn,
+    CountColumn,
+    TotalColumn,
+    AverageColumn,
+    MaxColumn,
+    LockWaitColumn,
+    ParseColumn,
+    OutputColumn,
+    HistogramColumn,
+    ColumnCount
+};
+
+const int REFRESH_INTERVAL_MS = 1000;
+
+}
+
+CommandProfilerWidget::CommandProfilerWidget(MainWindow *main) :
+    IaitoDockWidget(main)
+{
+    setObjectName(main->getUniqueObjectName("CommandProfilerWidget"));
+    setWindowTitle(tr("Command Profiler"));
+
+    auto container = new QWidget(this);
+    auto layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    auto toolBar = new QToolBar(container);
+    recordAction = toolBar->addAction(tr("Record"));
+    recordAction->setCheckable(true);
+    recordAction->setChecked(CommandProfiler::instance()->isEnabled());
+    toolBar->addAction(tr("Reset"), this, &CommandProfilerWidget::resetStats);
+    toolBar->addAction(tr("Export Chrome Trace..."), this, &CommandProfilerWidget::exportChromeTrace);
+    layout->addWidget(toolBar);
+
+    lockLabel = new QLabel(container);
+    lockLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(lockLabel);
+
+    statsTree = new QTreeWidget(container);
+    statsTree->setRootIsDecorated(false);
+    statsTree->setUniformRowHeights(true);
+    statsTree->setSortingEnabled(true);
+    statsTree->setHeaderLabels({ tr("Context"), tr("Command"), tr("Count"), tr("Total (ms)"),
+                                 tr("Average (us)"), tr("Max (us)"), tr("Lock wait (ms)"),
+                                 tr("Parse (ms)"), tr("Output (KiB)"), tr("Histogram (1us - 1s)") });
+    statsTree->sortByColumn(TotalColumn, Qt::DescendingOrder);
+    statsTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    layout->addWidget(statsTree);
+
+    setWidget(container);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(refreshTimer, &QTimer::timeout, this, &CommandProfilerWidget::refreshStats);
+    connect(recordAction, &QAction::toggled, this, &CommandProfilerWidget::setRecording);
+    connect(CommandProfiler::instance(), &CommandProfiler::enabledChanged, recordAction, &QAction::setChecked);
+    connect(this, &IaitoDockWidget::becameVisibleToUser, this, &CommandProfilerWidget::refreshStats);
+
+    refreshStats();
+}
+
+CommandProfilerWidget::~CommandProfilerWidget() {}
+
+void CommandProfilerWidget::setRecording(bool enabled)
+{
+    CommandProfiler::instance()->setEnabled(enabled);
+    if (enabled) {
+        refreshTimer->start();
+    } else {
+        refreshTimer->stop();
+        refreshStats();
+    }
+}
+
+void CommandProfilerWidget::resetStats()
+{
+    CommandProfiler::instance()->reset();
+    Core()->resetCoreLockStats();
+    Core()->resetQueryCacheStats();
+    refreshStats();
+}
+
+void CommandProfilerWidget::refreshStats()
+{
+    if (!isVisibleToUser()) {
+        return;
+    }
+
+    CoreLockStats lockStats = Core()->getCoreLockStats();
+    QueryCacheStats cacheStats = Core()->getQueryCacheStats();
+    lockLabel->setText(tr("Core lock: %1 exclusive, %2 shared, %3 contended (%4 ms waited). "
+                          "GUI thread: %5 contended, %6 ms waited, %7 ms worst.")
+                       .arg(lockStats.exclusiveLocks)
+                       .arg(lockStats.sharedLocks)
+                       .arg(lockStats.contendedLocks)
+                       .arg(lockStats.totalWaitNs / 1e6, 0, 'f', 1)
+                       .arg(lockStats.guiThreadContendedLocks)
+                       .arg(lockStats.guiThreadWaitNs / 1e6, 0, 'f', 1)
+                       .arg(lockStats.maxGuiThreadWaitNs / 1e6, 0, 'f', 1)
+                       + QLatin1Char('\n')
+                       + tr("Query cache: %1 hits, %2 misses, analysis generation %3.")
+                       .arg(cacheStats.hits)
+                       .arg(cacheStats.misses)
+                       .arg(cacheStats.generation));
+
+    statsTree->setUpdatesEnabled(false);
+    statsTree->setSortingEnabled(false);
+    statsTree->clear();
+    QList<QTreeWidgetItem *> items;
+    for (const CommandProfiler::Stats &stats : CommandProfiler::instance()->getStats()) {
+        auto item = new QTreeWidgetItem();
+        item->setText(ContextColumn, stats.context);
+        item->setText(CommandColumn, stats.command);
+        item->setData(CountColumn, Qt::DisplayRole, stats.count);
+        item->setData(TotalColumn, Qt::DisplayRole, qRound(stats.totalNs / 1e4) / 100.0);
+        item->setData(AverageColumn, Qt::DisplayRole, qRound64(stats.totalNs / 1e3 / stats.count));
+        item->setData(MaxColumn, Qt::DisplayRole, qRound64(stats.maxNs / 1e3));
+        item->setData(LockWaitColumn, Qt::DisplayRole, qRound(stats.lockWaitNs / 1e4) / 100.0);
+        item->setData(ParseColumn, Qt::DisplayRole, qRound(stats.parseNs / 1e4) / 100.0);
+        item->setData(OutputColumn, Qt::DisplayRole, qRound64(stats.outputBytes / 1024.0));
+        item->setText(HistogramColumn, histogramText(stats.histogram));
+
+        QStringList buckets;
+        for (int i = 0; i < stats.histogram.size(); i++) {
+            if (stats.histogram[i]) {
+                buckets << tr("%1 us: %2").arg(1ull << i).arg(stats.histogram[i]);
+            }
+        }
+        item->setToolTip(HistogramColumn, buckets.join(QLatin1Char('\n')));
+        items.append(item);
+    }
+    statsTree->addTopLevelItems(items);
+    statsTree->setSortingEnabled(true);
+    statsTree->setUpdatesEnabled(true);
+}
+
+QString CommandProfilerWidget::histogramText(const QVector<quint64> &histogram)
+{
+    // 2^20 us is already above one second
+    static const int shownBuckets = 21;
+    static const QChar bars[] = { QChar(0x2581), QChar(0x2582), QChar(0x2583), QChar(0x2584),
+                                  QChar(0x2585), QChar(0x2586), QChar(0x2587), QChar(0x2588) };
+
+    quint64 max = 0;
+    for (quint64 count : histogram) {
+        max = std::max(max, count);
+    }
+    QString ret;
+    for (int i = 0; i < shownBuckets && i < histogram.size(); i++) {
+        quint64 count = histogram[i];
+        if (i == shownBuckets - 1) {
+            for (int j = shownBuckets; j < histogram.size(); j++) {
+                count += histogram[j];
+            }
+        }
+        if (!count) {
+            ret += QLatin1Char(' ');
+            continue;
+        }
+        int level = static_cast<int>(count * 7 / max);
+        ret += bars[std::min(level, 7)];
+    }
+    return ret;
+}
+
+void CommandProfilerWidget::exportChromeTrace()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Chrome Trace"),
+                                                    Config()->getRecentFolder(),
+                                                    tr("Trace (*.json)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    Config()->setRecentFolder(QFileInfo(fileName).absolutePath());
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        QMessageBox::critical(this, tr("Error"), file.errorString());
+        return;
+    }
+    file.write(CommandProfiler::instance()->toChromeTrace());
+}
@@ -0,0 +1,40 @@
+#ifndef COMMANDPROFILERWIDGET_H
+#define COMMANDPROFILERWIDGET_H
+
+#include "core/Iaito.h"
+#include "IaitoDockWidget.h"
+
+class MainWindow;
+class QTreeWidget;
+class QLabel;
+class QAction;
+class QTimer;
+
+/**
+ * @brief Shows the latency of the r2 commands recorded by CommandProfiler,
+ * grouped by the widget or task that issued them.
+ */
+class CommandProfilerWidget : public IaitoDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CommandProfilerWidget(MainWindow *main);
+    ~CommandProfilerWidget() override;
+
+private slots:
+    void refreshStats();
+    void setRecording(bool enabled);
+    void resetStats();
+    void exportChromeTrace();
+
+private:
+    static QString histogramText(const QVector<quint64> &histogram);
+
+    QTreeWidget *statsTree;
+    QLabel *lockLabel;
+    QAction *recordAction;
+    QTimer *refreshTimer;
+};
+
+#endif // COMMANDPROFILERWIDGET_H
@@ -3,7 +3,7 @@
 #include "common/Helpers.h"
 #include "common/JsonModel.h"
 #include "common/JsonTreeItem.h"
-#include "common/TempConfig.h"
+#include "common/CommandProfiler.h"
 #include "dialogs/VersionInfoDialog.h"
 
 #include "core/MainWindow.h"
@@ -34,7 +34,21 @@ Dashboard::~Dashboard() {}
 
 void Dashboard::updateContents()
 {
-    QJsonDocument docu = Core()->getFileInfo();
+    CommandProfiler::Context profilerContext(objectName());
+
+    // Everything the dashboard shows, fetched under a single core lock.
+    // The entropy is computed over the whole file, from physical offset 0 to $s
+    const QStringList outputs = Core()->cmdBatch({
+        "ij",
+        "itj",
+        "ph entropy $s @ 0 @e:io.va=false",
+        "aaij",
+        "il",
+        "iCj",
+        "iVj"
+    });
+
+    QJsonDocument docu = Core()->parseJson(outputs[0].toUtf8().constData(), "ij");
     QJsonObject item = docu.object()["core"].toObject();
     QJsonObject item2 = docu.object()["bin"].toObject();
 
@@ -78,7 +92,7 @@ void Dashboard::updateContents()
 
     // Add file hashes, analysis info and libraries
 
-    QJsonObject hashes = Core()->cmdj("itj").object();
+    QJsonObject hashes = Core()->parseJson(outputs[1].toUtf8().constData(), "itj").object();
 
     // Delete hashesWidget if it isn't null to avoid duplicate components
     if (hashesWidget) {
@@ -111,13 +125,7 @@ void Dashboard::updateContents()
 
     // Add the Entropy value of the file to the dashboard
     {
-        // Scope for TempConfig
-        TempConfig tempConfig;
-        tempConfig.set("io.va", false);
-
-        // Calculate the Entropy of the entire binary from offset 0 to $s
-        // where $s is the size of the entire file
-        QString entropy = Core()->cmdRawAt("ph entropy $s", 0).trimmed();
+        QString entropy = outputs[2].trimmed();
 
         // Define a Read-Only line edit to display the entropy value
         QLineEdit *entropyLineEdit = new QLineEdit();
@@ -126,7 +134,7 @@ void Dashboard::updateContents()
         hashesLayout->addRow(new QLabel(tr("<b>Entropy:</b>")), entropyLineEdit);
     }
 
-    QJsonObject analinfo = Core()->cmdj("aaij").object();
+    QJsonObject analinfo = Core()->parseJson(outputs[3].toUtf8().constData(), "aaij").object();
     setPlainText(ui->functionsLineEdit, QString::number(analinfo["fcns"].toInt()));
     setPlainText(ui->xRefsLineEdit, QString::number(analinfo["xrefs"].toInt()));
     setPlainText(ui->callsLineEdit, QString::number(analinfo["calls"].toInt()));
@@ -137,7 +145,7 @@ void Dashboard::updateContents()
     setPlainText(ui->codeSizeLineEdit, QString::number(analinfo["codesz"].toInt()) + " bytes");
     setPlainText(ui->percentageLineEdit, QString::number(analinfo["percent"].toInt()) + "%");
 
-    QStringList libs = Core()->cmdList("il");
+    QStringList libs = outputs[4].split(QLatin1Char('\n'), IAITO_QT_SKIP_EMPTY_PARTS);
     if (!libs.isEmpty()) {
         libs.removeFirst();
         libs.removeLast();
@@ -175,10 +183,10 @@ void Dashboard::updateContents()
     QStringList stats = Core()->getStats();
 
     // Check if signature info and version info available
-    if (Core()->getSignatureInfo().isEmpty()) {
+    if (Core()->parseJson(outputs[5].toUtf8().constData(), "iCj").isEmpty()) {
         ui->certificateButton->setEnabled(false);
     }
-    if (Core()->getFileVersionInfo().isEmpty()) {
+    if (Core()->parseJson(outputs[6].toUtf8().constData(), "iVj").isEmpty()) {
         ui->versioninfoButton->setEnabled(false);
     }
 
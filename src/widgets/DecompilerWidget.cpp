@@ -10,6 +10,7 @@
 #include "common/IaitoSeekable.h"
 #include "core/MainWindow.h"
 #include "common/DecompilerHighlighter.h"
+#include "common/CommandProfiler.h"
 
 #include <QTextEdit>
 #include <QPlainTextEdit>
@@ -229,6 +230,9 @@ void DecompilerWidget::doRefresh()
     if (!refreshDeferrer->attemptRefresh(nullptr)) {
         return;
     }
+
+    CommandProfiler::Context profilerContext(objectName());
+
     if (ui->decompilerComboBox->currentIndex() < 0) {
         return;
     }
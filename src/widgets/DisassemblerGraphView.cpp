@@ -10,6 +10,7 @@
 #include "common/BasicBlockHighlighter.h"
 #include "common/BasicInstructionHighlighter.h"
 #include "common/Helpers.h"
+#include "common/CommandProfiler.h"
 
 #include <QColorDialog>
 #include <QPainter>
@@ -19,7 +20,6 @@
 #include <QPropertyAnimation>
 #include <QShortcut>
 #include <QToolTip>
-#include <QTextDocument>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QRegularExpression>
@@ -51,6 +51,10 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent, IaitoSeekable *see
     connect(Core(), &IaitoCore::functionsChanged, this, &DisassemblerGraphView::refreshView);
     connect(Core(), &IaitoCore::asmOptionsChanged, this, &DisassemblerGraphView::refreshView);
     connect(Core(), &IaitoCore::refreshCodeViews, this, &DisassemblerGraphView::refreshView);
+    connect(Core(), &IaitoCore::registersChanged, this, [this]() {
+        programCounter = Core()->getProgramCounterValue();
+        viewport()->update();
+    });
 
     connectSeekChanged(false);
 
@@ -164,12 +168,15 @@ DisassemblerGraphView::~DisassemblerGraphView()
 void DisassemblerGraphView::refreshView()
 {
     IaitoGraphView::refreshView();
+    programCounter = Core()->getProgramCounterValue();
     loadCurrentGraph();
     emit viewRefreshed();
 }
 
 void DisassemblerGraphView::loadCurrentGraph()
 {
+    CommandProfiler::Context profilerContext(QStringLiteral("Graph"));
+
     TempConfig tempConfig;
     tempConfig.set("scr.color", COLOR_MODE_16M)
     .set("asm.lines", false)
@@ -184,8 +191,16 @@ void DisassemblerGraphView::loadCurrentGraph()
         functions = functionsDoc.array();
     }
 
-    disassembly_blocks.clear();
-    blocks.clear();
+    // Keep the previous blocks around, unchanged ones are reused below
+    std::unordered_map<ut64, DisassemblyBlock> oldDisassemblyBlocks;
+    std::unordered_map<ut64, GraphBlock> oldBlocks;
+    oldDisassemblyBlocks.swap(disassembly_blocks);
+    oldBlocks.swap(blocks);
+    bool reuseBlocks = fcn && fcn->addr == loadedFcnAddr
+                       && charWidth == loadedCharWidth && charHeight == loadedCharHeight;
+    loadedFcnAddr = fcn ? fcn->addr : RVA_INVALID;
+    loadedCharWidth = charWidth;
+    loadedCharHeight = charHeight;
 
     if (highlight_token) {
         delete highlight_token;
@@ -224,35 +239,37 @@ void DisassemblerGraphView::loadCurrentGraph()
     RVA entry = func["offset"].toVariant().toULongLong();
 
     setEntry(entry);
+    const int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
+                            Core()->getConfigb("asm.emu") * 10;
+    const bool showEntryOffset = Config()->getGraphBlockEntryOffset();
+    const QColor offsetColor = ConfigColor("offset");
+    bool sizesFit = true;
     for (const QJsonValueRef value : func["blocks"].toArray()) {
         QJsonObject block = value.toObject();
         RVA block_entry = block["offset"].toVariant().toULongLong();
         RVA block_size = block["size"].toVariant().toULongLong();
         RVA block_fail = block["fail"].toVariant().toULongLong();
         RVA block_jump = block["jump"].toVariant().toULongLong();
+        QJsonArray opArray = block["ops"].toArray();
+
+        // Everything the rendered block depends on
+        uint sourceHash = qHash(block_size, qHash(block_fail, qHash(block_jump)));
+        sourceHash = qHash(qMakePair(blockLength, showEntryOffset), sourceHash);
+        sourceHash = qHash(offsetColor.rgba(), sourceHash);
+        for (const QJsonValueRef opValue : opArray) {
+            QJsonObject op = opValue.toObject();
+            sourceHash = qHash(op["offset"].toVariant().toULongLong(), sourceHash);
+            sourceHash = qHash(op["text"].toString(), sourceHash);
+        }
 
-        DisassemblyBlock db;
         GraphBlock gb;
         gb.entry = block_entry;
-        db.entry = block_entry;
-        if (Config()->getGraphBlockEntryOffset()) {
-            // QColor(0,0,0,0) is transparent
-            db.header_text = Text("[" + RAddressString(db.entry) + "]", ConfigColor("offset"),
-                                  QColor(0, 0, 0, 0));
-        }
-        db.true_path = RVA_INVALID;
-        db.false_path = RVA_INVALID;
         if (block_fail) {
-            db.false_path = block_fail;
             gb.edges.emplace_back(block_fail);
         }
         if (block_jump) {
-            if (block_fail) {
-                db.true_path = block_jump;
-            }
             gb.edges.emplace_back(block_jump);
         }
-
         QJsonObject switchOp = block["switchop"].toObject();
         if (!switchOp.isEmpty()) {
             QJsonArray caseArray = switchOp["cases"].toArray();
@@ -267,7 +284,34 @@ void DisassemblerGraphView::loadCurrentGraph()
             }
         }
 
-        QJsonArray opArray = block["ops"].toArray();
+        auto oldDb = oldDisassemblyBlocks.find(block_entry);
+        auto oldGb = oldBlocks.find(block_entry);
+        if (reuseBlocks && oldDb != oldDisassemblyBlocks.end() && oldGb != oldBlocks.end()
+                && oldDb->second.sourceHash == sourceHash) {
+            disassembly_blocks[block_entry] = std::move(oldDb->second);
+            gb.width = oldGb->second.width;
+            gb.height = oldGb->second.height;
+            addBlock(gb);
+            continue;
+        }
+
+        DisassemblyBlock db;
+        db.entry = block_entry;
+        db.sourceHash = sourceHash;
+        if (Config()->getGraphBlockEntryOffset()) {
+            // QColor(0,0,0,0) is transparent
+            db.header_text = Text("[" + RAddressString(db.entry) + "]", ConfigColor("offset"),
+                                  QColor(0, 0, 0, 0));
+        }
+        db.true_path = RVA_INVALID;
+        db.false_path = RVA_INVALID;
+        if (block_fail) {
+            db.false_path = block_fail;
+        }
+        if (block_jump && block_fail) {
+            db.true_path = block_jump;
+        }
+
         for (int opIndex = 0; opIndex < opArray.size(); opIndex++) {
             QJsonObject op = opArray[opIndex].toObject();
             Instr i;
@@ -282,17 +326,10 @@ void DisassemblerGraphView::loadCurrentGraph()
                 i.size = (block_entry + block_size) - i.addr;
             }
 
-            QTextDocument textDoc;
-            textDoc.setHtml(IaitoCore::ansiEscapeToHtml(op["text"].toString()));
-
-            i.plainText = textDoc.toPlainText();
-
-            RichTextPainter::List richText = RichTextPainter::fromTextDocument(textDoc);
-            //Colors::colorizeAssembly(richText, textDoc.toPlainText(), 0);
+            RichTextPainter::List richText = RichTextPainter::fromAnsi(op["text"].toString(),
+                                                                        &i.plainText);
 
             bool cropped;
-            int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
-                              Core()->getConfigb("asm.emu") * 10;
             i.text = Text(RichTextPainter::cropped(richText, blockLength, "...", &cropped));
             if (cropped)
                 i.fullText = richText;
@@ -300,18 +337,56 @@ void DisassemblerGraphView::loadCurrentGraph()
                 i.fullText = Text();
             db.instrs.push_back(i);
         }
-        disassembly_blocks[db.entry] = db;
+        disassembly_blocks[db.entry] = std::move(db);
         prepareGraphNode(gb);
+        if (oldGb != oldBlocks.end()
+                && (gb.width > oldGb->second.width || gb.height > oldGb->second.height)) {
+            sizesFit = false;
+        }
 
         addBlock(gb);
     }
     cleanupEdges(blocks);
 
-    if (!func["blocks"].toArray().isEmpty()) {
+    if (func["blocks"].toArray().isEmpty()) {
+        return;
+    }
+    if (reuseBlocks && sizesFit && !isPlacementOutdated() && reusePlacement(oldBlocks)) {
+        setCacheDirty();
+        viewport()->update();
+    } else {
         computeGraphPlacement();
     }
 }
 
+bool DisassemblerGraphView::reusePlacement(const std::unordered_map<ut64, GraphBlock> &oldBlocks)
+{
+    if (oldBlocks.size() != blocks.size()) {
+        return false;
+    }
+    for (const auto &it : blocks) {
+        auto old = oldBlocks.find(it.first);
+        if (old == oldBlocks.end() || old->second.edges.size() != it.second.edges.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < it.second.edges.size(); i++) {
+            if (old->second.edges[i].target != it.second.edges[i].target) {
+                return false;
+            }
+        }
+    }
+    // Same topology and every block still fits in its old rectangle, keep the previous layout
+    for (auto &it : blocks) {
+        const GraphBlock &old = oldBlocks.at(it.first);
+        it.second.x = old.x;
+        it.second.y = old.y;
+        it.second.width = old.width;
+        it.second.height = old.height;
+        it.second.edges = old.edges;
+    }
+    return true;
+}
+
 DisassemblerGraphView::EdgeConfigurationMapping DisassemblerGraphView::getEdgeConfigurations()
 {
     EdgeConfigurationMapping result;
@@ -371,7 +446,7 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block,
 
     // Figure out if the current block is selected
     RVA addr = seekable->getOffset();
-    RVA PCAddr = Core()->getProgramCounterValue();
+    RVA PCAddr = programCounter;
     for (const Instr &instr : db.instrs) {
         if (instr.contains(addr) && interactive) {
             block_selected = true;
@@ -947,11 +1022,35 @@ void DisassemblerGraphView::restoreCurrentBlock()
 
 void DisassemblerGraphView::paintEvent(QPaintEvent *event)
 {
-    // DisassemblerGraphView is always dirty
-    setCacheDirty();
+    // Selection, highlighted token and PC are drawn into the cached tiles,
+    // everything else marks the cache dirty when it changes
+    uint stateHash = qHash(seekable->getOffset(), qHash(programCounter));
+    stateHash = qHash(Core()->getAnalysisGeneration(), stateHash);
+    if (highlight_token) {
+        stateHash = qHash(highlight_token->content, stateHash);
+    }
+    if (stateHash != paintedStateHash) {
+        paintedStateHash = stateHash;
+        setCacheDirty();
+    }
+    DisassemblyBlock *db = blockForAddress(seekable->getOffset());
+    selectedBlockEntry = db ? db->entry : RVA_INVALID;
     GraphView::paintEvent(event);
 }
 
+void DisassemblerGraphView::drawBlockOverview(QPainter &p, GraphView::GraphBlock &block,
+                                              bool interactive)
+{
+    QRectF blockRect(block.x, block.y, block.width, block.height);
+    p.setPen(QPen(graphNodeColor, 0));
+    if (interactive && block.entry == selectedBlockEntry) {
+        p.setBrush(disassemblySelectedBackgroundColor);
+    } else {
+        p.setBrush(disassemblyBackgroundColor);
+    }
+    p.drawRect(blockRect);
+}
+
 bool DisassemblerGraphView::Instr::contains(ut64 addr) const
 {
     return this->addr <= addr && (addr - this->addr) < size;
@@ -84,6 +84,8 @@ class DisassemblerGraphView : public IaitoGraphView
         ut64 false_path = 0;
         bool terminal = false;
         bool indirectcall = false;
+        /** Hash of the agJ data the block was built from */
+        uint sourceHash = 0;
     };
 
 public:
@@ -131,6 +133,7 @@ public slots:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void drawBlockOverview(QPainter &p, GraphView::GraphBlock &block, bool interactive) override;
     void blockContextMenuRequested(GraphView::GraphBlock &block, QContextMenuEvent *event,
                                    QPoint pos) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
@@ -153,6 +156,11 @@ private:
     void connectSeekChanged(bool disconnect);
 
     void prepareGraphNode(GraphBlock &block);
+    /**
+     * @brief Copy positions and edge routes from \a oldBlocks if the graph topology did not change.
+     * @return false if a new layout must be computed
+     */
+    bool reusePlacement(const std::unordered_map<ut64, GraphBlock> &oldBlocks);
     Token *getToken(Instr *instr, int x);
 
     QPoint getInstructionOffset(const DisassemblyBlock &block, int line) const;
@@ -180,6 +188,16 @@ private:
     QAction actionUnhighlightInstruction;
 
     QLabel *emptyText = nullptr;
+    /** What the cached tiles were drawn with, see paintEvent() */
+    uint paintedStateHash = 0;
+    /** Read on refresh, not per paint or block, since it may be a round trip to the target */
+    RVA programCounter = RVA_INVALID;
+    RVA selectedBlockEntry = RVA_INVALID;
+
+    // What the current blocks were built for, to decide if they can be reused on refresh
+    RVA loadedFcnAddr = RVA_INVALID;
+    qreal loadedCharWidth = 0;
+    int loadedCharHeight = 0;
 
 signals:
     void nameChanged(const QString &name);
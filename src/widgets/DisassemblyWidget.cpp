@@ -4,6 +4,7 @@
 #include "common/Helpers.h"
 #include "common/TempConfig.h"
 #include "common/SelectionHighlight.h"
+#include "common/CommandProfiler.h"
 #include "core/MainWindow.h"
 
 #include <QApplication>
@@ -17,6 +18,7 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QSplitter>
+#include <QTimer>
 
 
 class DisassemblyTextBlockUserData: public QTextBlockUserData
@@ -55,6 +57,8 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
     cursorLineOffset = 0;
     cursorCharOffset = 0;
     seekFromCursor = false;
+    pendingScrollCount = 0;
+    scrollTimerArmed = false;
 
     // Instantiate the window layout
     auto *splitter = new QSplitter;
@@ -136,7 +140,7 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
             this, &DisassemblyWidget::showDisasContextMenu);
 
 
-    connect(mDisasScrollArea, &DisassemblyScrollArea::scrollLines, this, &DisassemblyWidget::scrollInstructions);
+    connect(mDisasScrollArea, &DisassemblyScrollArea::scrollLines, this, &DisassemblyWidget::queueScrollInstructions);
     connect(mDisasScrollArea, &DisassemblyScrollArea::disassemblyResized, this, &DisassemblyWidget::updateMaxLines);
 
     connectCursorPositionChanged(false);
@@ -260,6 +264,8 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
         return;
     }
 
+    CommandProfiler::Context profilerContext(objectName());
+
     if (offset != RVA_INVALID) {
         topOffset = offset;
     }
@@ -308,14 +314,7 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
         cursor.setBlockFormat(regular);
     }
 
-    if (!lines.isEmpty()) {
-        bottomOffset = lines[qMin(lines.size(), maxLines) - 1].offset;
-        if (bottomOffset < topOffset) {
-            bottomOffset = RVA_MAX;
-        }
-    } else {
-        bottomOffset = topOffset;
-    }
+    updateBottomOffset();
 
     connectCursorPositionChanged(false);
 
@@ -336,6 +335,146 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
     leftPanel->update();
 }
 
+void DisassemblyWidget::updateBottomOffset()
+{
+    if (!lines.isEmpty()) {
+        bottomOffset = lines[qMin(lines.size(), maxLines) - 1].offset;
+        if (bottomOffset < topOffset) {
+            bottomOffset = RVA_MAX;
+        }
+    } else {
+        bottomOffset = topOffset;
+    }
+}
+
+bool DisassemblyWidget::scrollDisasm(RVA offset, int instructions)
+{
+    // Only a full screen of lines kept block by block in the document can be shifted,
+    // everything else (first refresh, end of the address space, hidden widget) is rebuilt
+    QTextDocument *document = mDisasTextEdit->document();
+    if (offset == topOffset || topOffset == RVA_INVALID || maxLines <= 0 || !isVisibleToUser()
+            || lines.size() != maxLines || document->blockCount() != maxLines) {
+        return false;
+    }
+
+    CommandProfiler::Context profilerContext(objectName());
+
+    QList<DisassemblyLine> newLines;
+    int removeTop = 0;
+    int removeBottom = 0;
+    if (offset > topOffset) {
+        while (removeTop < lines.size() && lines[removeTop].offset < offset) {
+            removeTop++;
+        }
+        if (removeTop == lines.size() || lines[removeTop].offset != offset) {
+            return false;
+        }
+        // The last instruction may be cut after its comments, disassemble it again
+        const RVA lastOffset = lines.last().offset;
+        while (removeBottom < lines.size() - removeTop
+               && lines[lines.size() - 1 - removeBottom].offset == lastOffset) {
+            removeBottom++;
+        }
+        if (removeTop + removeBottom >= lines.size()) {
+            return false;
+        }
+        TempConfig tempConfig;
+        tempConfig.set("scr.color", COLOR_MODE_16M)
+        .set("asm.lines", false);
+        newLines = Core()->disassembleLines(lastOffset, removeTop + removeBottom);
+        if (newLines.size() != removeTop + removeBottom) {
+            return false;
+        }
+        for (const DisassemblyLine &line : newLines) {
+            if (line.offset < lastOffset) { // overflow
+                return false;
+            }
+        }
+    } else {
+        // There may be more lines than instructions, give comments and labels some room
+        const int fetchLines = qMin(maxLines, 2 * instructions + 4);
+        TempConfig tempConfig;
+        tempConfig.set("scr.color", COLOR_MODE_16M)
+        .set("asm.lines", false);
+        QList<DisassemblyLine> fetched = Core()->disassembleLines(offset, fetchLines);
+        int aligned = 0;
+        while (aligned < fetched.size() && fetched[aligned].offset < topOffset
+               && fetched[aligned].offset >= offset) {
+            aligned++;
+        }
+        if (aligned == 0 || aligned == fetched.size() || fetched[aligned].offset != topOffset) {
+            return false;
+        }
+        newLines = fetched.mid(0, aligned);
+        removeBottom = newLines.size();
+    }
+
+    breakpoints = Core()->getBreakpointsAddresses();
+    int horizontalScrollValue = mDisasTextEdit->horizontalScrollBar()->value();
+    mDisasTextEdit->setLockScroll(true); // avoid flicker
+    connectCursorPositionChanged(true);
+
+    QTextCursor cursor(document);
+    if (removeTop) {
+        cursor.movePosition(QTextCursor::Start);
+        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, removeTop);
+        cursor.removeSelectedText();
+    }
+    if (removeBottom) {
+        cursor.movePosition(QTextCursor::End);
+        cursor.movePosition(QTextCursor::PreviousBlock, QTextCursor::MoveAnchor, removeBottom);
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+    }
+
+    lines = lines.mid(removeTop, lines.size() - removeTop - removeBottom);
+    if (offset > topOffset) {
+        cursor.movePosition(QTextCursor::End);
+        for (const DisassemblyLine &line : newLines) {
+            cursor.insertBlock();
+            cursor.insertHtml(line.text);
+        }
+        lines.append(newLines);
+    } else {
+        cursor.movePosition(QTextCursor::Start);
+        for (const DisassemblyLine &line : newLines) {
+            cursor.insertHtml(line.text);
+            cursor.insertBlock();
+        }
+        lines = newLines + lines;
+    }
+
+    // Blocks were split and merged at the edges, reassign every line to its block
+    const QColor breakpointBackground = ConfigColor("gui.breakpoint_background");
+    QTextBlock block = document->begin();
+    for (const DisassemblyLine &line : lines) {
+        if (!block.isValid()) {
+            break;
+        }
+        QTextCursor blockCursor(block);
+        QTextBlockFormat f;
+        if (Core()->isBreakpoint(breakpoints, line.offset)) {
+            f.setBackground(breakpointBackground);
+        }
+        blockCursor.setBlockFormat(f);
+        block.setUserData(new DisassemblyTextBlockUserData(line));
+        block = block.next();
+    }
+
+    topOffset = offset;
+    updateBottomOffset();
+
+    connectCursorPositionChanged(false);
+
+    updateCursorPosition();
+
+    mDisasTextEdit->setLockScroll(false);
+    mDisasTextEdit->horizontalScrollBar()->setValue(horizontalScrollValue);
+
+    leftPanel->update();
+    return true;
+}
 
 void DisassemblyWidget::scrollInstructions(int count)
 {
@@ -356,7 +495,28 @@ void DisassemblyWidget::scrollInstructions(int count)
         }
     }
 
-    refreshDisasm(offset);
+    if (!scrollDisasm(offset, qAbs(count))) {
+        refreshDisasm(offset);
+    }
+}
+
+void DisassemblyWidget::queueScrollInstructions(int count)
+{
+    // Wheel and touchpad events can arrive faster than the disassembly is updated,
+    // apply all of them at once when the event loop gets idle
+    // The count alone can not tell if the timer is armed, opposite deltas may cancel out
+    if (!scrollTimerArmed) {
+        scrollTimerArmed = true;
+        QTimer::singleShot(0, this, [this]() {
+            scrollTimerArmed = false;
+            int count = pendingScrollCount;
+            pendingScrollCount = 0;
+            if (count) {
+                scrollInstructions(count);
+            }
+        });
+    }
+    pendingScrollCount += count;
 }
 
 
@@ -872,7 +1032,7 @@ void DisassemblyLeftPanel::wheelEvent(QWheelEvent *event) {
     int count = -(event->angleDelta() / 15).y();
     count -= (count > 0 ? 5 : -5);
 
-    this->disas->scrollInstructions(count);
+    this->disas->queueScrollInstructions(count);
 }
 
 void DisassemblyLeftPanel::paintEvent(QPaintEvent *event)
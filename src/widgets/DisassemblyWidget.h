@@ -44,6 +44,11 @@ public slots:
     void fontsUpdatedSlot();
     void colorsUpdatedSlot();
     void scrollInstructions(int count);
+    /**
+     * @brief Like scrollInstructions(), but merges the counts of all calls made before
+     * control returns to the event loop.
+     */
+    void queueScrollInstructions(int count);
     void seekPrev();
     void setPreviewMode(bool previewMode);
     QFontMetrics getFontMetrics();
@@ -78,9 +83,19 @@ private:
     int cursorLineOffset;
     int cursorCharOffset;
     bool seekFromCursor;
+    int pendingScrollCount;
+    bool scrollTimerArmed;
 
     RefreshDeferrer *disasmRefresh;
 
+    /**
+     * @brief Move the view to \a offset, \a instructions away from topOffset, by
+     * disassembling only the lines that become visible and shifting the others.
+     * @return false if the view has to be rebuilt with refreshDisasm() instead
+     */
+    bool scrollDisasm(RVA offset, int instructions);
+    void updateBottomOffset();
+
     RVA readCurrentDisassemblyOffset();
     RVA readDisassemblyOffset(QTextCursor tc);
     bool eventFilter(QObject *obj, QEvent *event) override;
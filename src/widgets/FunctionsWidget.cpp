@@ -500,11 +500,9 @@ FunctionsWidget::~FunctionsWidget() {}
 
 void FunctionsWidget::refreshTree()
 {
-    if (task) {
-        task->wait();
-    }
-
+    // A pending fetch is dropped and a running one discards its result
     task = QSharedPointer<FunctionsTask>(new FunctionsTask());
+    task->setCoalescingKey(QString("functions-%1").arg(reinterpret_cast<quintptr>(this)));
     connect(task.data(), &FunctionsTask::fetchFinished,
     this, [this] (const QList<FunctionDescription> &functions) {
         functionModel->beginResetModel();
@@ -258,6 +258,22 @@ void GraphGridLayout::selectTree(GraphGridLayout::LayoutState &state)
     }
 }
 
+std::unique_ptr<GraphLayout> GraphGridLayout::clone() const
+{
+    return std::unique_ptr<GraphLayout>(new GraphGridLayout(*this));
+}
+
+std::unique_ptr<GraphLayout> GraphGridLayout::provisionalLayout() const
+{
+    if (!useLayoutOptimization) {
+        return nullptr;
+    }
+    std::unique_ptr<GraphGridLayout> result(new GraphGridLayout(*this));
+    result->cancelFlag = nullptr;
+    result->useLayoutOptimization = false;
+    return result;
+}
+
 void GraphGridLayout::CalculateLayout(GraphLayout::Graph &blocks, ut64 entry, int &width, int &height) const
 {
     LayoutState layoutState;
@@ -277,6 +293,9 @@ void GraphGridLayout::CalculateLayout(GraphLayout::Graph &blocks, ut64 entry, in
 
     auto blockOrder = topoSort(layoutState, entry);
     computeAllBlockPlacement(blockOrder, layoutState);
+    if (isCancelled()) {
+        return;
+    }
 
     for (auto &blockIt : blocks) {
         layoutState.edge[blockIt.first].resize(blockIt.second.edges.size());
@@ -318,7 +337,7 @@ void GraphGridLayout::CalculateLayout(GraphLayout::Graph &blocks, ut64 entry, in
     routeEdges(layoutState);
 
     convertToPixelCoordinates(layoutState, width, height);
-    if (useLayoutOptimization) {
+    if (useLayoutOptimization && !isCancelled()) {
         optimizeLayout(layoutState);
         cropToContent(blocks, width, height);
     }
@@ -1631,6 +1650,9 @@ void GraphGridLayout::optimizeLayout(GraphGridLayout::LayoutState &state) const
     optimizeLinearProgram(solution.size(), objectiveFunction, inequalities, equalities, solution);
     copyVariablesToPositions(solution, true);
     connectEdgeEnds(*state.blocks);
+    if (isCancelled()) {
+        return;
+    }
 
     // vertical segments
     variableGroups.resize(blockMapping.size());
@@ -27,6 +27,11 @@ public:
     void setParentBetweenDirectChild(bool enabled) { parentBetweenDirectChild = enabled; }
     void setverticalBlockAlignmentMiddle(bool enabled) { verticalBlockAlignmentMiddle = enabled; }
     void setLayoutOptimization(bool enabled) { useLayoutOptimization = enabled; }
+    std::unique_ptr<GraphLayout> clone() const override;
+    /**
+     * @brief Same grid placement without the layout optimization step
+     */
+    std::unique_ptr<GraphLayout> provisionalLayout() const override;
 private:
     /// false - use bounding box for smallest subtree when placing them side by side
     bool tightSubtreePlacement = false;
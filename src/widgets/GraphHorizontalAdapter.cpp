@@ -52,6 +52,33 @@ void GraphHorizontalAdapter::setLayoutConfig(const GraphLayout::LayoutConfig &co
     layout->setLayoutConfig(config);
 }
 
+std::unique_ptr<GraphLayout> GraphHorizontalAdapter::clone() const
+{
+    return wrap(layout->clone());
+}
+
+std::unique_ptr<GraphLayout> GraphHorizontalAdapter::provisionalLayout() const
+{
+    return wrap(layout->provisionalLayout());
+}
+
+void GraphHorizontalAdapter::setCancelFlag(const std::atomic<bool> *flag)
+{
+    GraphLayout::setCancelFlag(flag);
+    layout->setCancelFlag(flag);
+}
+
+std::unique_ptr<GraphLayout> GraphHorizontalAdapter::wrap(std::unique_ptr<GraphLayout> inner) const
+{
+    if (!inner) {
+        return nullptr;
+    }
+    std::unique_ptr<GraphHorizontalAdapter> result(new GraphHorizontalAdapter(std::move(inner)));
+    // the inner layout keeps its configuration, only the swapped copy of the adapter is missing
+    result->layoutConfig = layoutConfig;
+    return result;
+}
+
 void GraphHorizontalAdapter::swapLayoutConfigDirection()
 {
     std::swap(layoutConfig.edgeVerticalSpacing, layoutConfig.edgeHorizontalSpacing);
@@ -16,7 +16,11 @@ public:
                                  int &width,
                                  int &height) const override;
     void setLayoutConfig(const LayoutConfig &config) override;
+    std::unique_ptr<GraphLayout> clone() const override;
+    std::unique_ptr<GraphLayout> provisionalLayout() const override;
+    void setCancelFlag(const std::atomic<bool> *flag) override;
 private:
+    std::unique_ptr<GraphLayout> wrap(std::unique_ptr<GraphLayout> inner) const;
     std::unique_ptr<GraphLayout> layout;
     void swapLayoutConfigDirection();
 };
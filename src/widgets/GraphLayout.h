@@ -1,9 +1,14 @@
 #ifndef GRAPHLAYOUT_H
 #define GRAPHLAYOUT_H
 
-#include "core/Iaito.h"
+#include "core/IaitoCommon.h"
+
+#include <QPolygonF>
 
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <vector>
 
 class GraphLayout
 {
@@ -46,8 +51,26 @@ public:
     {
         this->layoutConfig = config;
     };
+    /**
+     * @brief Independent copy that can calculate the layout on another thread.
+     * @return nullptr if the layout does not support it
+     */
+    virtual std::unique_ptr<GraphLayout> clone() const { return nullptr; }
+    /**
+     * @brief Cheaper variant of the layout to show while the real one is calculated.
+     * @return nullptr if there is no faster variant
+     */
+    virtual std::unique_ptr<GraphLayout> provisionalLayout() const { return nullptr; }
+    /**
+     * @brief Flag checked between the expensive steps of CalculateLayout(). Once it is set
+     * CalculateLayout() returns early and leaves the blocks in an undefined state.
+     */
+    virtual void setCancelFlag(const std::atomic<bool> *flag) { cancelFlag = flag; }
 protected:
     LayoutConfig layoutConfig;
+    const std::atomic<bool> *cancelFlag = nullptr;
+
+    bool isCancelled() const { return cancelFlag && cancelFlag->load(); }
 };
 
 #endif // GRAPHLAYOUT_H
@@ -0,0 +1,146 @@
+#include "GraphSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Inclusive bounding box, unlike QRectF it is not empty for straight lines
+ */
+static QRectF segmentBounds(const QPointF &a, const QPointF &b)
+{
+    return QRectF(QPointF(std::min(a.x(), b.x()), std::min(a.y(), b.y())),
+                  QPointF(std::max(a.x(), b.x()), std::max(a.y(), b.y())));
+}
+
+void GraphSpatialIndex::clear()
+{
+    bounds = QRectF();
+    columns = 0;
+    rows = 0;
+    blockCells.clear();
+    edgeCells.clear();
+}
+
+void GraphSpatialIndex::build(const GraphLayout::Graph &blocks)
+{
+    clear();
+    if (blocks.empty()) {
+        return;
+    }
+
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+    qreal right = std::numeric_limits<qreal>::lowest();
+    qreal bottom = std::numeric_limits<qreal>::lowest();
+    qreal blockArea = 0;
+    auto extend = [&](const QRectF &rect) {
+        left = std::min(left, rect.left());
+        top = std::min(top, rect.top());
+        right = std::max(right, rect.right());
+        bottom = std::max(bottom, rect.bottom());
+    };
+    for (const auto &it : blocks) {
+        const GraphLayout::GraphBlock &block = it.second;
+        extend(QRectF(block.x, block.y, block.width, block.height));
+        blockArea += qreal(block.width) * block.height;
+        for (const GraphLayout::GraphEdge &edge : block.edges) {
+            if (!edge.polyline.isEmpty()) {
+                extend(edge.polyline.boundingRect());
+            }
+        }
+    }
+    bounds = QRectF(QPointF(left, top), QPointF(right, bottom));
+
+    // About the size of an average block, but no more than a few cells per block
+    cellSize = std::max<qreal>(64, std::sqrt(blockArea / blocks.size()));
+    cellSize = std::max(cellSize, std::sqrt(bounds.width() * bounds.height() / (4.0 * blocks.size())));
+    columns = int(bounds.width() / cellSize) + 1;
+    rows = int(bounds.height() / cellSize) + 1;
+    blockCells.resize(size_t(columns) * rows);
+    edgeCells.resize(size_t(columns) * rows);
+
+    int firstColumn, firstRow, lastColumn, lastRow;
+    for (const auto &it : blocks) {
+        const GraphLayout::GraphBlock &block = it.second;
+        if (cellRange(QRectF(block.x, block.y, block.width, block.height),
+                      firstColumn, firstRow, lastColumn, lastRow)) {
+            for (int row = firstRow; row <= lastRow; row++) {
+                for (int column = firstColumn; column <= lastColumn; column++) {
+                    blockCells[size_t(row) * columns + column].push_back(it.first);
+                }
+            }
+        }
+        for (size_t i = 0; i < block.edges.size(); i++) {
+            const QPolygonF &polyline = block.edges[i].polyline;
+            for (int point = 0; point < polyline.size(); point++) {
+                const QPointF &next = polyline[std::min(point + 1, polyline.size() - 1)];
+                if (!cellRange(segmentBounds(polyline[point], next),
+                               firstColumn, firstRow, lastColumn, lastRow)) {
+                    continue;
+                }
+                for (int row = firstRow; row <= lastRow; row++) {
+                    for (int column = firstColumn; column <= lastColumn; column++) {
+                        auto &cell = edgeCells[size_t(row) * columns + column];
+                        // consecutive segments mostly share cells
+                        if (cell.empty() || cell.back() != EdgeRef(it.first, i)) {
+                            cell.emplace_back(it.first, i);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool GraphSpatialIndex::cellRange(const QRectF &area, int &firstColumn, int &firstRow,
+                                  int &lastColumn, int &lastRow) const
+{
+    if (!columns || area.left() > bounds.right() || area.right() < bounds.left()
+            || area.top() > bounds.bottom() || area.bottom() < bounds.top()) {
+        return false;
+    }
+    firstColumn = qBound(0, int((area.left() - bounds.left()) / cellSize), columns - 1);
+    lastColumn = qBound(0, int((area.right() - bounds.left()) / cellSize), columns - 1);
+    firstRow = qBound(0, int((area.top() - bounds.top()) / cellSize), rows - 1);
+    lastRow = qBound(0, int((area.bottom() - bounds.top()) / cellSize), rows - 1);
+    return true;
+}
+
+std::vector<ut64> GraphSpatialIndex::blocksIn(const QRectF &area) const
+{
+    std::vector<ut64> result;
+    int firstColumn, firstRow, lastColumn, lastRow;
+    if (!cellRange(area, firstColumn, firstRow, lastColumn, lastRow)) {
+        return result;
+    }
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            const auto &cell = blockCells[size_t(row) * columns + column];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    }
+    if (firstColumn != lastColumn || firstRow != lastRow) {
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+    return result;
+}
+
+std::vector<GraphSpatialIndex::EdgeRef> GraphSpatialIndex::edgesIn(const QRectF &area) const
+{
+    std::vector<EdgeRef> result;
+    int firstColumn, firstRow, lastColumn, lastRow;
+    if (!cellRange(area, firstColumn, firstRow, lastColumn, lastRow)) {
+        return result;
+    }
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            const auto &cell = edgeCells[size_t(row) * columns + column];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef GRAPHSPATIALINDEX_H
+#define GRAPHSPATIALINDEX_H
+
+#include "GraphLayout.h"
+
+#include <QRectF>
+#include <vector>
+#include <utility>
+
+/**
+ * @brief Uniform grid over the blocks and edge segments of a laid out graph, for hit testing
+ * and culling without walking the whole graph.
+ *
+ * Only block entries and edge indices are stored, so the graph can be modified freely as long
+ * as build() is called again once positions change.
+ */
+class GraphSpatialIndex
+{
+public:
+    /**
+     * @brief Identifies GraphLayout::GraphBlock::edges[second] of the block with entry first
+     */
+    using EdgeRef = std::pair<ut64, size_t>;
+
+    void build(const GraphLayout::Graph &blocks);
+    void clear();
+
+    /**
+     * @brief Entries of the blocks whose bounding boxes touch \a area, each reported once.
+     * Candidates only, callers still have to check the exact shape.
+     */
+    std::vector<ut64> blocksIn(const QRectF &area) const;
+    /**
+     * @brief Edges with a segment whose bounding box touches \a area, each reported once
+     */
+    std::vector<EdgeRef> edgesIn(const QRectF &area) const;
+
+private:
+    QRectF bounds;
+    qreal cellSize = 1;
+    int columns = 0;
+    int rows = 0;
+    std::vector<std::vector<ut64>> blockCells;
+    std::vector<std::vector<EdgeRef>> edgeCells;
+
+    /**
+     * @return false if \a area is outside of the grid
+     */
+    bool cellRange(const QRectF &area, int &firstColumn, int &firstRow, int &lastColumn,
+                   int &lastRow) const;
+};
+
+#endif // GRAPHSPATIALINDEX_H
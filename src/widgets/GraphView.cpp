@@ -6,8 +6,10 @@
 #endif
 #include "GraphHorizontalAdapter.h"
 #include "Helpers.h"
+#include "common/GraphLayoutTask.h"
 
 #include <vector>
+#include <algorithm>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QKeyEvent>
@@ -42,6 +44,7 @@ GraphView::GraphView(QWidget *parent)
 
 GraphView::~GraphView()
 {
+    cancelLayoutTask();
 }
 
 // Callbacks
@@ -130,9 +133,92 @@ void GraphView::contextMenuEvent(QContextMenuEvent *event)
     }
 }
 
+/**
+ * Graphs with fewer blocks are laid out synchronously
+ */
+static const size_t BACKGROUND_LAYOUT_MIN_BLOCKS = 200;
+
 void GraphView::computeGraphPlacement()
 {
-    graphLayoutSystem->CalculateLayout(blocks, entry, width, height);
+    cancelLayoutTask();
+
+    std::unique_ptr<GraphLayout> provisional;
+    std::unique_ptr<GraphLayout> background;
+    if (blocks.size() >= BACKGROUND_LAYOUT_MIN_BLOCKS) {
+        provisional = graphLayoutSystem->provisionalLayout();
+        if (provisional) {
+            background = graphLayoutSystem->clone();
+        }
+    }
+
+    if (background) {
+        provisional->CalculateLayout(blocks, entry, width, height);
+        layoutTask.reset(new GraphLayoutTask(std::move(background), blocks, entry));
+        connect(layoutTask.data(), &GraphLayoutTask::layoutFinished,
+                this, &GraphView::onLayoutTaskFinished);
+        Core()->getAsyncTaskManager()->start(layoutTask);
+    } else {
+        graphLayoutSystem->CalculateLayout(blocks, entry, width, height);
+    }
+    placementOutdated = false;
+    setCacheDirty();
+    clampViewOffset();
+    viewport()->update();
+}
+
+void GraphView::cancelLayoutTask()
+{
+    if (!layoutTask) {
+        return;
+    }
+    disconnect(layoutTask.data(), nullptr, this, nullptr);
+    layoutTask->interrupt();
+    layoutTask.reset();
+}
+
+void GraphView::onLayoutTaskFinished()
+{
+    if (!layoutTask || sender() != layoutTask.data()) {
+        return;
+    }
+    QSharedPointer<GraphLayoutTask> task = layoutTask;
+    layoutTask.reset();
+
+    // The blocks may have been replaced while the layout was calculated
+    const GraphLayout::Graph &result = task->getBlocks();
+    if (result.size() != blocks.size()) {
+        return;
+    }
+    for (const auto &it : blocks) {
+        auto resultIt = result.find(it.first);
+        if (resultIt == result.end()
+                || resultIt->second.edges.size() != it.second.edges.size()
+                || resultIt->second.width != it.second.width
+                || resultIt->second.height != it.second.height) {
+            return;
+        }
+    }
+
+    // Keep the block at the center of the view where it is on screen
+    QPoint center(viewport()->width() / 2, viewport()->height() / 2);
+    GraphBlock *anchor = getBlockContaining(viewToLogicalCoordinates(center));
+    QPoint anchorView;
+    if (anchor) {
+        anchorView = logicalToViewCoordinates(QPoint(anchor->x, anchor->y));
+    }
+
+    for (auto &it : blocks) {
+        const GraphBlock &laidOut = result.at(it.first);
+        it.second.x = laidOut.x;
+        it.second.y = laidOut.y;
+        it.second.edges = laidOut.edges;
+    }
+    width = task->getWidth();
+    height = task->getHeight();
+
+    if (anchor) {
+        setViewOffsetInternal(QPoint(anchor->x, anchor->y) - anchorView / current_scale);
+    }
     setCacheDirty();
     clampViewOffset();
     viewport()->update();
@@ -177,48 +263,21 @@ void GraphView::setViewScale(qreal scale)
     emit viewScaleChanged(scale);
 }
 
-QSize GraphView::getCacheSize()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? cacheSize :
-#endif
-        pixmap.size();
-}
-
-qreal GraphView::getCacheDevicePixelRatioF()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? 1.0 :
-#endif
-        qhelpers::devicePixelRatio(&pixmap);
-}
-
 QSize GraphView::getRequiredCacheSize()
 {
     return viewport()->size() * qhelpers::devicePixelRatio(this);
 }
 
-qreal GraphView::getRequiredCacheDevicePixelRatioF()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? 1.0f :
-#endif
-        qhelpers::devicePixelRatio(this);
-}
-
 void GraphView::paintEvent(QPaintEvent *)
 {
-#ifndef IAITO_NO_OPENGL_GRAPH
-    if (useGL) {
-        glWidget->makeCurrent();
+    if (!useGL) {
+        paintTiles();
+        return;
     }
-#endif
+#ifndef IAITO_NO_OPENGL_GRAPH
+    glWidget->makeCurrent();
 
-    if (!qFuzzyCompare(getCacheDevicePixelRatioF(), getRequiredCacheDevicePixelRatioF())
-            || getCacheSize() != getRequiredCacheSize()) {
+    if (cacheSize != getRequiredCacheSize()) {
         setCacheDirty();
     }
 
@@ -227,23 +286,100 @@ void GraphView::paintEvent(QPaintEvent *)
         cacheDirty = false;
     }
 
-    if (useGL) {
-#ifndef IAITO_NO_OPENGL_GRAPH
-        auto gl = glWidget->context()->extraFunctions();
-        gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, cacheFBO);
-        gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glWidget->defaultFramebufferObject());
-        auto dpr = qhelpers::devicePixelRatio(this);
-        gl->glBlitFramebuffer(0, 0, cacheSize.width(), cacheSize.height(),
-                              0, 0, viewport()->width() * dpr, viewport()->height() * dpr,
-                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
-        glWidget->doneCurrent();
+    auto gl = glWidget->context()->extraFunctions();
+    gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, cacheFBO);
+    gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glWidget->defaultFramebufferObject());
+    auto dpr = qhelpers::devicePixelRatio(this);
+    gl->glBlitFramebuffer(0, 0, cacheSize.width(), cacheSize.height(),
+                          0, 0, viewport()->width() * dpr, viewport()->height() * dpr,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glWidget->doneCurrent();
 #endif
-    } else {
-        QPainter p(viewport());
-        p.drawPixmap(QPoint(0, 0), pixmap);
+}
+
+/**
+ * @brief Rounds towards negative infinity, the view offset can be negative
+ */
+static int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+void GraphView::paintTiles()
+{
+    const qreal dpr = qhelpers::devicePixelRatio(this);
+    if (cacheDirty || !qFuzzyCompare(dpr, tileDevicePixelRatio)) {
+        tiles.clear();
+        tileDevicePixelRatio = dpr;
+        cacheDirty = false;
+    }
+
+    QPainter p(viewport());
+    p.fillRect(viewport()->rect(), backgroundColor);
+
+    // Top left corner of the view in the pixel grid of the current scale
+    const QPoint origin(qRound(offset.x() * current_scale), qRound(offset.y() * current_scale));
+    const int firstX = floorDiv(origin.x(), TILE_SIZE);
+    const int firstY = floorDiv(origin.y(), TILE_SIZE);
+    const int lastX = floorDiv(origin.x() + viewport()->width() - 1, TILE_SIZE);
+    const int lastY = floorDiv(origin.y() + viewport()->height() - 1, TILE_SIZE);
+    for (int y = firstY; y <= lastY; y++) {
+        for (int x = firstX; x <= lastX; x++) {
+            const TileKey key = qMakePair(current_scale, qMakePair(x, y));
+            auto it = tiles.find(key);
+            if (it == tiles.end()) {
+                it = tiles.insert(key, { renderTile(x, y, dpr), 0 });
+            }
+            it->lastUse = ++tileUseCounter;
+            p.drawPixmap(QPoint(x * TILE_SIZE - origin.x(), y * TILE_SIZE - origin.y()), it->pixmap);
+        }
+    }
+
+    // Keep roughly 64 MiB of tiles, the least recently drawn ones go first
+    const int tileBytes = qRound(TILE_SIZE * dpr) * qRound(TILE_SIZE * dpr) * 4;
+    const int maxTiles = std::max((lastX - firstX + 1) * (lastY - firstY + 1),
+                                  64 * 1024 * 1024 / tileBytes);
+    if (tiles.size() > maxTiles) {
+        std::vector<quint64> uses;
+        uses.reserve(tiles.size());
+        for (const Tile &tile : tiles) {
+            uses.push_back(tile.lastUse);
+        }
+        auto nth = uses.end() - maxTiles;
+        std::nth_element(uses.begin(), nth, uses.end());
+        const quint64 minUse = *nth;
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (it->lastUse < minUse) {
+                it = tiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
 }
 
+QPixmap GraphView::renderTile(int x, int y, qreal dpr)
+{
+    QPixmap tile(qRound(TILE_SIZE * dpr), qRound(TILE_SIZE * dpr));
+    tile.setDevicePixelRatio(dpr);
+    tile.fill(backgroundColor);
+
+    const qreal logicalSize = TILE_SIZE / current_scale;
+    const QRectF area(x * logicalSize, y * logicalSize, logicalSize, logicalSize);
+    QPainter p(&tile);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.scale(current_scale, current_scale);
+    p.translate(-area.topLeft());
+    paintContents(p, area, current_scale, true);
+    return tile;
+}
+
+void GraphView::drawBlockOverview(QPainter &p, GraphView::GraphBlock &block, bool interactive)
+{
+    Q_UNUSED(interactive);
+    p.fillRect(QRectF(block.x, block.y, block.width, block.height), Qt::gray);
+}
+
 void GraphView::clampViewOffset()
 {
     const qreal edgeFraction = 0.25;
@@ -271,64 +407,45 @@ void GraphView::addViewOffset(QPoint move, bool emitSignal)
 void GraphView::paintGraphCache()
 {
 #ifndef IAITO_NO_OPENGL_GRAPH
-    std::unique_ptr<QOpenGLPaintDevice> paintDevice;
-#endif
-    QPainter p;
-    if (useGL) {
-#ifndef IAITO_NO_OPENGL_GRAPH
-        auto gl = QOpenGLContext::currentContext()->functions();
-
-        bool resizeTex = false;
-        QSize sizeNeed = getRequiredCacheSize();
-        if (!cacheTexture) {
-            gl->glGenTextures(1, &cacheTexture);
-            gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            resizeTex = true;
-        } else if (cacheSize != sizeNeed) {
-            gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
-            resizeTex = true;
-        }
-        if (resizeTex) {
-            cacheSize = sizeNeed;
-            gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, cacheSize.width(), cacheSize.height(), 0, GL_RGBA,
-                             GL_UNSIGNED_BYTE, nullptr);
-            gl->glGenFramebuffers(1, &cacheFBO);
-            gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
-            gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cacheTexture, 0);
-        } else {
-            gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
-        }
-        gl->glViewport(0, 0, viewport()->width(), viewport()->height());
-        gl->glClearColor(backgroundColor.redF(), backgroundColor.greenF(), backgroundColor.blueF(), 1.0f);
-        gl->glClear(GL_COLOR_BUFFER_BIT);
-
-        paintDevice.reset(new QOpenGLPaintDevice(cacheSize));
-        p.begin(paintDevice.get());
-#endif
+    auto gl = QOpenGLContext::currentContext()->functions();
+
+    bool resizeTex = false;
+    QSize sizeNeed = getRequiredCacheSize();
+    if (!cacheTexture) {
+        gl->glGenTextures(1, &cacheTexture);
+        gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        resizeTex = true;
+    } else if (cacheSize != sizeNeed) {
+        gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        resizeTex = true;
+    }
+    if (resizeTex) {
+        cacheSize = sizeNeed;
+        gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, cacheSize.width(), cacheSize.height(), 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, nullptr);
+        gl->glGenFramebuffers(1, &cacheFBO);
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
+        gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cacheTexture, 0);
     } else {
-        auto dpr = qhelpers::devicePixelRatio(this);
-        pixmap = QPixmap(getRequiredCacheSize() * dpr);
-        pixmap.setDevicePixelRatio(dpr);
-        pixmap.fill(backgroundColor);
-        p.begin(&pixmap);
-        p.setRenderHint(QPainter::Antialiasing);
-        p.setViewport(this->viewport()->rect());
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
     }
-    paint(p, offset, this->viewport()->rect(), current_scale);
+    gl->glViewport(0, 0, viewport()->width(), viewport()->height());
+    gl->glClearColor(backgroundColor.redF(), backgroundColor.greenF(), backgroundColor.blueF(), 1.0f);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
 
-    p.end();
+    QOpenGLPaintDevice paintDevice(cacheSize);
+    QPainter p(&paintDevice);
+    paint(p, offset, this->viewport()->rect(), current_scale);
+#endif
 }
 
 void GraphView::paint(QPainter &p, QPoint offset, QRect viewport, qreal scale, bool interactive)
 {
-    QPointF offsetF(offset.x(), offset.y());
-    p.setBrush(Qt::black);
-
     int render_width = viewport.width();
     int render_height = viewport.height();
 
@@ -337,80 +454,103 @@ void GraphView::paint(QPainter &p, QPoint offset, QRect viewport, qreal scale, b
     p.setWindow(window);
     QRectF windowF(window.x(), window.y(), window.width(), window.height());
 
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
+    paintContents(p, windowF, scale, interactive);
+}
+
+void GraphView::paintContents(QPainter &p, const QRectF &area, qreal scale, bool interactive)
+{
+    p.setBrush(Qt::black);
+
+    // Below this scale text would be unreadable, blocks are only drawn as rectangles
+    const bool detailed = scale * qhelpers::devicePixelRatio(p.device()) >= minimumDetailScale();
+    const GraphSpatialIndex &index = getSpatialIndex();
+
+    for (ut64 entry : index.blocksIn(area)) {
+        auto blockIt = blocks.find(entry);
+        if (blockIt == blocks.end()) {
+            continue;
+        }
+        GraphBlock &block = blockIt->second;
 
         QRectF blockRect(block.x, block.y, block.width, block.height);
 
         // Check if block is visible by checking if block intersects with view area
-        if (blockRect.intersects(windowF)) {
-            drawBlock(p, block, interactive);
+        if (blockRect.intersects(area)) {
+            if (detailed) {
+                drawBlock(p, block, interactive);
+            } else {
+                drawBlockOverview(p, block, interactive);
+            }
         }
+    }
 
-        p.setBrush(Qt::gray);
+    p.setBrush(Qt::gray);
 
-        // Always draw edges
-        // TODO: Only draw edges if they are actually visible ...
-        // Draw edges
-        for (GraphEdge &edge : block.edges) {
-            if (edge.polyline.empty()) {
-                continue;
-            }
-            QPolygonF polyline = edge.polyline;
-            EdgeConfiguration ec = edgeConfiguration(block, &blocks[edge.target], interactive);
-            QPen pen(ec.color);
-            pen.setStyle(ec.lineStyle);
-            pen.setWidthF(pen.width() * ec.width_scale);
-            if (scale_thickness_multiplier && ec.width_scale > 1.01 && pen.widthF() * scale < 2) {
-                pen.setWidthF(ec.width_scale / scale);
-            }
-            if (pen.widthF() * scale < 2) {
-                pen.setWidth(0);
-            }
-            p.setPen(pen);
-            p.setBrush(ec.color);
-            p.drawPolyline(polyline);
-            pen.setStyle(Qt::SolidLine);
+    // Draw edges, arrow heads stick out of the polylines
+    for (const GraphSpatialIndex::EdgeRef &edgeRef : index.edgesIn(area.adjusted(-8, -8, 8, 8))) {
+        auto blockIt = blocks.find(edgeRef.first);
+        if (blockIt == blocks.end() || edgeRef.second >= blockIt->second.edges.size()) {
+            continue;
+        }
+        GraphBlock &block = blockIt->second;
+        GraphEdge &edge = block.edges[edgeRef.second];
+        if (edge.polyline.empty()) {
+            continue;
+        }
+        QPolygonF polyline = edge.polyline;
+        EdgeConfiguration ec = edgeConfiguration(block, &blocks[edge.target], interactive);
+        QPen pen(ec.color);
+        pen.setStyle(ec.lineStyle);
+        pen.setWidthF(pen.width() * ec.width_scale);
+        if (scale_thickness_multiplier && ec.width_scale > 1.01 && pen.widthF() * scale < 2) {
+            pen.setWidthF(ec.width_scale / scale);
+        }
+        if (pen.widthF() * scale < 2) {
+            pen.setWidth(0);
+        }
+        p.setPen(pen);
+        p.setBrush(ec.color);
+        p.drawPolyline(polyline);
+        pen.setStyle(Qt::SolidLine);
+        p.setPen(pen);
+
+        auto drawArrow = [&](QPointF tip, QPointF dir) {
+            pen.setWidth(0);
             p.setPen(pen);
-
-            auto drawArrow = [&](QPointF tip, QPointF dir) {
-                pen.setWidth(0);
-                p.setPen(pen);
-                QPolygonF arrow;
-                arrow << tip;
-                QPointF dy(-dir.y(), dir.x());
-                QPointF base = tip - dir * 6;
-                arrow << base + 3 * dy;
-                arrow << base - 3 * dy;
-                p.drawConvexPolygon(arrow);
-            };
-
-            if (!polyline.empty()) {
-                if (ec.start_arrow) {
-                    auto firstPt = edge.polyline.first();
-                    drawArrow(firstPt, QPointF(0, 1));
-                }
-                if (ec.end_arrow) {
-                    auto lastPt = edge.polyline.last();
-                    QPointF dir(0, -1);
-                    switch (edge.arrow) {
-                    case GraphLayout::GraphEdge::Down:
-                        dir = QPointF(0, 1);
-                        break;
-                    case GraphLayout::GraphEdge::Up:
-                        dir = QPointF(0, -1);
-                        break;
-                    case GraphLayout::GraphEdge::Left:
-                        dir = QPointF(-1, 0);
-                        break;
-                    case GraphLayout::GraphEdge::Right:
-                        dir = QPointF(1, 0);
-                        break;
-                    default:
-                        break;
-                    }
-                    drawArrow(lastPt, dir);
+            QPolygonF arrow;
+            arrow << tip;
+            QPointF dy(-dir.y(), dir.x());
+            QPointF base = tip - dir * 6;
+            arrow << base + 3 * dy;
+            arrow << base - 3 * dy;
+            p.drawConvexPolygon(arrow);
+        };
+
+        if (!polyline.empty()) {
+            if (ec.start_arrow) {
+                auto firstPt = edge.polyline.first();
+                drawArrow(firstPt, QPointF(0, 1));
+            }
+            if (ec.end_arrow) {
+                auto lastPt = edge.polyline.last();
+                QPointF dir(0, -1);
+                switch (edge.arrow) {
+                case GraphLayout::GraphEdge::Down:
+                    dir = QPointF(0, 1);
+                    break;
+                case GraphLayout::GraphEdge::Up:
+                    dir = QPointF(0, -1);
+                    break;
+                case GraphLayout::GraphEdge::Left:
+                    dir = QPointF(-1, 0);
+                    break;
+                case GraphLayout::GraphEdge::Right:
+                    dir = QPointF(1, 0);
+                    break;
+                default:
+                    break;
                 }
+                drawArrow(lastPt, dir);
             }
         }
     }
@@ -507,11 +647,24 @@ void GraphView::showRectangle(const QRect &block, bool anywhere)
     viewport()->update();
 }
 
+const GraphSpatialIndex &GraphView::getSpatialIndex()
+{
+    if (spatialIndexDirty) {
+        spatialIndex.build(blocks);
+        spatialIndexDirty = false;
+    }
+    return spatialIndex;
+}
+
 GraphView::GraphBlock *GraphView::getBlockContaining(QPoint p)
 {
     // Check if a block was clicked
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
+    for (ut64 entry : getSpatialIndex().blocksIn(QRectF(p, QSizeF(0, 0)))) {
+        auto blockIt = blocks.find(entry);
+        if (blockIt == blocks.end()) {
+            continue;
+        }
+        GraphBlock &block = blockIt->second;
 
         QRect rec(block.x, block.y, block.width, block.height);
         if (rec.contains(p)) {
@@ -537,10 +690,18 @@ void GraphView::setGraphLayout(std::unique_ptr<GraphLayout> layout)
     if (!graphLayoutSystem) {
         graphLayoutSystem = makeGraphLayout(Layout::GridMedium);
     }
+    placementOutdated = true;
 }
 
 void GraphView::setLayoutConfig(const GraphLayout::LayoutConfig &config)
 {
+    if (config.blockVerticalSpacing != currentLayoutConfig.blockVerticalSpacing
+            || config.blockHorizontalSpacing != currentLayoutConfig.blockHorizontalSpacing
+            || config.edgeVerticalSpacing != currentLayoutConfig.edgeVerticalSpacing
+            || config.edgeHorizontalSpacing != currentLayoutConfig.edgeHorizontalSpacing) {
+        currentLayoutConfig = config;
+        placementOutdated = true;
+    }
     graphLayoutSystem->setLayoutConfig(config);
 }
 
@@ -652,26 +813,29 @@ void GraphView::mousePressEvent(QMouseEvent *event)
 
     // Check if a line beginning/end  was clicked
     if (event->button() == Qt::LeftButton) {
-        for (auto &blockIt : blocks) {
-            GraphBlock &block = blockIt.second;
-            for (GraphEdge &edge : block.edges) {
-                if (edge.polyline.length() < 2) {
-                    continue;
-                }
-                QPointF start = edge.polyline.first();
-                QPointF end = edge.polyline.last();
-                if (checkPointClicked(start, pos.x(), pos.y())) {
-                    showBlock(blocks[edge.target]);
-                    // TODO: Callback to child
-                    return;
-                    break;
-                }
-                if (checkPointClicked(end, pos.x(), pos.y(), true)) {
-                    showBlock(block);
-                    // TODO: Callback to child
-                    return;
-                    break;
-                }
+        // Covers the click targets of checkPointClicked() around both ends
+        QRectF targetArea(pos.x() - 5, pos.y() - 15, 10, 30);
+        for (const GraphSpatialIndex::EdgeRef &edgeRef : getSpatialIndex().edgesIn(targetArea)) {
+            auto blockIt = blocks.find(edgeRef.first);
+            if (blockIt == blocks.end() || edgeRef.second >= blockIt->second.edges.size()) {
+                continue;
+            }
+            GraphBlock &block = blockIt->second;
+            GraphEdge &edge = block.edges[edgeRef.second];
+            if (edge.polyline.length() < 2) {
+                continue;
+            }
+            QPointF start = edge.polyline.first();
+            QPointF end = edge.polyline.last();
+            if (checkPointClicked(start, pos.x(), pos.y())) {
+                showBlock(blocks[edge.target]);
+                // TODO: Callback to child
+                return;
+            }
+            if (checkPointClicked(end, pos.x(), pos.y(), true)) {
+                showBlock(block);
+                // TODO: Callback to child
+                return;
             }
         }
     }
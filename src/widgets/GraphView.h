@@ -9,6 +9,8 @@
 #include <QElapsedTimer>
 #include <QHelpEvent>
 #include <QGestureEvent>
+#include <QSharedPointer>
+#include <QHash>
 
 #include <unordered_map>
 #include <unordered_set>
@@ -17,6 +19,7 @@
 
 #include "core/Iaito.h"
 #include "widgets/GraphLayout.h"
+#include "widgets/GraphSpatialIndex.h"
 
 #if defined(QT_NO_OPENGL) || QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
 // QOpenGLExtraFunctions were introduced in 5.6
@@ -27,6 +30,8 @@
 class QOpenGLWidget;
 #endif
 
+class GraphLayoutTask;
+
 class GraphView : public QAbstractScrollArea
 {
     Q_OBJECT
@@ -94,11 +99,20 @@ public:
     void setLayoutConfig(const GraphLayout::LayoutConfig &config);
 
     void paint(QPainter &p, QPoint offset, QRect area, qreal scale = 1.0, bool interactive = true);
+    /**
+     * @brief Draw the blocks and edges intersecting \a area, in logical coordinates, with the
+     * painter transformation already set up.
+     */
+    void paintContents(QPainter &p, const QRectF &area, qreal scale, bool interactive = true);
 
     void saveAsBitmap(QString path, const char *format = nullptr, double scaler = 1.0,
                       bool transparent = false);
     void saveAsSvg(QString path);
 
+    /**
+     * @brief Lay out the blocks. Large graphs get a provisional layout right away, the
+     * real one is calculated in the background and replaces it once finished.
+     */
     void computeGraphPlacement();
 
     /**
@@ -114,7 +128,16 @@ protected:
     // Padding inside the block
     int block_padding = 16;
 
-    void setCacheDirty()    { cacheDirty = true; }
+    void setCacheDirty()    { cacheDirty = true; spatialIndexDirty = true; }
+    /**
+     * @brief Index of the current block and edge positions, rebuilt after setCacheDirty()
+     */
+    const GraphSpatialIndex &getSpatialIndex();
+    /**
+     * @brief True if the layout or its configuration changed since the last computeGraphPlacement(),
+     * so positions of unchanged blocks cannot be reused.
+     */
+    bool isPlacementOutdated() const { return placementOutdated; }
 
     void addBlock(GraphView::GraphBlock block);
     void setEntry(ut64 e);
@@ -127,6 +150,14 @@ protected:
      * @param interactive - can be used for disabling elemnts during export
      */
     virtual void drawBlock(QPainter &p, GraphView::GraphBlock &block, bool interactive = true) = 0;
+    /**
+     * @brief Draw a block too small for its contents to be readable, see minimumDetailScale()
+     */
+    virtual void drawBlockOverview(QPainter &p, GraphView::GraphBlock &block, bool interactive = true);
+    /**
+     * @brief Scale in device pixels below which blocks are drawn with drawBlockOverview()
+     */
+    virtual qreal minimumDetailScale() const { return 0; }
     virtual void blockClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos);
     virtual void blockDoubleClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos);
     virtual void blockHelpEvent(GraphView::GraphBlock &block, QHelpEvent *event, QPoint pos);
@@ -174,6 +205,10 @@ private:
 
     void paintGraphCache();
 
+    void cancelLayoutTask();
+    void onLayoutTaskFinished();
+    QSharedPointer<GraphLayoutTask> layoutTask;
+
     bool checkPointClicked(QPointF &point, int x, int y, bool above_y = false);
 
     // Zoom data
@@ -193,9 +228,21 @@ private:
     bool useGL;
 
     /**
-     * @brief pixmap that caches the graph nodes
+     * @brief Rendered graph in square tiles of TILE_SIZE view pixels, by scale and tile position.
+     * Panning only renders the tiles that were not visible yet.
      */
-    QPixmap pixmap;
+    static const int TILE_SIZE = 256;
+    using TileKey = QPair<qreal, QPair<int, int>>;
+    struct Tile {
+        QPixmap pixmap;
+        quint64 lastUse;
+    };
+    QHash<TileKey, Tile> tiles;
+    quint64 tileUseCounter = 0;
+    qreal tileDevicePixelRatio = 0;
+
+    void paintTiles();
+    QPixmap renderTile(int x, int y, qreal dpr);
 
 #ifndef IAITO_NO_OPENGL_GRAPH
     uint32_t cacheTexture;
@@ -208,10 +255,11 @@ private:
      * @brief flag to control if the cache is invalid and should be re-created in the next draw
      */
     bool cacheDirty = true;
-    QSize getCacheSize();
-    qreal getCacheDevicePixelRatioF();
+    bool spatialIndexDirty = true;
+    GraphSpatialIndex spatialIndex;
+    bool placementOutdated = true;
+    GraphLayout::LayoutConfig currentLayoutConfig;
     QSize getRequiredCacheSize();
-    qreal getRequiredCacheDevicePixelRatioF();
 
     void beginMouseDrag(QMouseEvent *event);
 public:
@@ -0,0 +1,83 @@
+#include "HexGlyphAtlas.h"
+
+#include <r_types.h>
+
+#include <cmath>
+
+void HexGlyphAtlas::setup(const QFont &font, qreal charWidth, qreal lineHeight, qreal devicePixelRatio)
+{
+    if (font == this->font && charWidth == this->charWidth && lineHeight == this->lineHeight
+            && devicePixelRatio == this->devicePixelRatio) {
+        return;
+    }
+    this->font = font;
+    this->charWidth = charWidth;
+    this->lineHeight = lineHeight;
+    this->devicePixelRatio = devicePixelRatio;
+    pixmaps.clear();
+}
+
+void HexGlyphAtlas::clear()
+{
+    pixmaps.clear();
+}
+
+QRectF HexGlyphAtlas::cellRect(uint8_t byte, bool ascii) const
+{
+    // 16x16 hex pairs followed by 16x16 characters, padded so that
+    // antialiasing of a glyph never bleeds into its neighbours
+    const qreal hexPitch = std::ceil(2 * charWidth) + 2;
+    const qreal asciiPitch = std::ceil(charWidth) + 2;
+    const qreal rowPitch = std::ceil(lineHeight) + 2;
+    const int row = byte >> 4;
+    const int column = byte & 0xf;
+    if (ascii) {
+        return QRectF(16 * hexPitch + column * asciiPitch, row * rowPitch, charWidth, lineHeight);
+    }
+    return QRectF(column * hexPitch, row * rowPitch, 2 * charWidth, lineHeight);
+}
+
+const QPixmap &HexGlyphAtlas::pixmap(const QColor &color)
+{
+    auto it = pixmaps.find(color.rgba());
+    if (it != pixmaps.end()) {
+        return it.value();
+    }
+
+    const QRectF bounds = cellRect(0xff, false).united(cellRect(0xff, true));
+    QPixmap pixmap((bounds.size() * devicePixelRatio).toSize() + QSize(1, 1));
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setFont(font);
+    painter.setPen(color);
+    for (int byte = 0; byte <= 0xff; byte++) {
+        painter.drawText(cellRect(byte, false), Qt::AlignVCenter,
+                         QString("%1").arg(byte, 2, 16, QLatin1Char('0')));
+        if (IS_PRINTABLE(byte)) {
+            painter.drawText(cellRect(byte, true), Qt::AlignVCenter, QString(QChar(byte)));
+        }
+    }
+    painter.end();
+
+    return pixmaps.insert(color.rgba(), pixmap).value();
+}
+
+QPainter::PixmapFragment HexGlyphAtlas::fragment(const QRectF &cell, const QPointF &pos) const
+{
+    // Source rectangles are in device pixels, targets are centered on pos
+    const QRectF source(cell.topLeft() * devicePixelRatio, cell.size() * devicePixelRatio);
+    return QPainter::PixmapFragment::create(pos + QPointF(cell.width() / 2, cell.height() / 2),
+                                            source, 1 / devicePixelRatio, 1 / devicePixelRatio);
+}
+
+QPainter::PixmapFragment HexGlyphAtlas::hexPair(uint8_t byte, const QPointF &pos) const
+{
+    return fragment(cellRect(byte, false), pos);
+}
+
+QPainter::PixmapFragment HexGlyphAtlas::ascii(uint8_t byte, const QPointF &pos) const
+{
+    return fragment(cellRect(byte, true), pos);
+}
@@ -0,0 +1,47 @@
+#ifndef HEXGLYPHATLAS_H
+#define HEXGLYPHATLAS_H
+
+#include <QFont>
+#include <QHash>
+#include <QPainter>
+#include <QPixmap>
+
+#include <cstdint>
+
+/**
+ * @brief Pre-rendered hex pairs and ASCII characters of one font.
+ *
+ * Items are blitted with QPainter::drawPixmapFragments instead of laying out
+ * text for every byte on screen. One pixmap is rendered lazily per text color.
+ */
+class HexGlyphAtlas
+{
+public:
+    /**
+     * @brief Drop the rendered glyphs if the font, metrics or pixel ratio changed
+     */
+    void setup(const QFont &font, qreal charWidth, qreal lineHeight, qreal devicePixelRatio);
+    void clear();
+
+    const QPixmap &pixmap(const QColor &color);
+    /**
+     * @brief Fragment drawing the two hex digits of \a byte in the cell whose top left corner is \a pos
+     */
+    QPainter::PixmapFragment hexPair(uint8_t byte, const QPointF &pos) const;
+    /**
+     * @brief Fragment drawing \a byte as a character in the cell whose top left corner is \a pos
+     */
+    QPainter::PixmapFragment ascii(uint8_t byte, const QPointF &pos) const;
+
+private:
+    QRectF cellRect(uint8_t byte, bool ascii) const;
+    QPainter::PixmapFragment fragment(const QRectF &cell, const QPointF &pos) const;
+
+    QFont font;
+    qreal charWidth = 0;
+    qreal lineHeight = 0;
+    qreal devicePixelRatio = 0;
+    QHash<QRgb, QPixmap> pixmaps;
+};
+
+#endif // HEXGLYPHATLAS_H
@@ -1,6 +1,8 @@
 #include "HexWidget.h"
 #include "Iaito.h"
 #include "Configuration.h"
+#include "common/CommandProfiler.h"
+#include "common/Helpers.h"
 #include "dialogs/WriteCommandsDialogs.h"
 
 #include <QPainter>
@@ -21,10 +23,162 @@
 #include <QRegularExpression>
 #include <QToolTip>
 #include <QActionGroup>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+MemoryBlockCache::MemoryBlockCache(int capacity)
+    : capacity(capacity)
+{
+}
+
+void MemoryBlockCache::setCapacity(int capacity)
+{
+    this->capacity = capacity;
+    evict(capacity);
+}
+
+QVector<QByteArray> MemoryBlockCache::fetch(uint64_t firstBlockAddr, int count)
+{
+    const quint64 currentGeneration = Core()->getAnalysisGeneration();
+    if (currentGeneration != generation) {
+        blocks.clear();
+        lru.clear();
+        generation = currentGeneration;
+    }
+
+    load(firstBlockAddr, count);
+
+    QVector<QByteArray> ret;
+    ret.reserve(count);
+    uint64_t addr = firstBlockAddr;
+    for (int i = 0; i < count; i++, addr += BLOCK_SIZE) {
+        auto it = blocks.find(addr);
+        if (it == blocks.end()) {
+            // Address space wrapped around
+            ret.append(QByteArray(static_cast<int>(BLOCK_SIZE), '\xff'));
+            continue;
+        }
+        lru.splice(lru.begin(), lru, it->lruPos);
+        ret.append(it->data);
+    }
+
+    // Prefetch the next screen in the scroll direction
+    const uint64_t screenSize = static_cast<uint64_t>(count) * BLOCK_SIZE;
+    if (firstBlockAddr > lastFirstBlockAddr && firstBlockAddr + 2 * screenSize > firstBlockAddr) {
+        load(firstBlockAddr + screenSize, count);
+    } else if (firstBlockAddr < lastFirstBlockAddr && firstBlockAddr >= screenSize) {
+        load(firstBlockAddr - screenSize, count);
+    }
+    lastFirstBlockAddr = firstBlockAddr;
+
+    // Never evict what is on screen and the prefetched blocks
+    evict(std::max(capacity, 3 * count));
+    return ret;
+}
+
+void MemoryBlockCache::load(uint64_t firstBlockAddr, int count)
+{
+    // Read every run of missing blocks with a single request, each one
+    // is a round trip when debugging remotely
+    int i = 0;
+    while (i < count) {
+        const uint64_t runAddr = firstBlockAddr + i * BLOCK_SIZE;
+        if (runAddr < firstBlockAddr) {
+            break;
+        }
+        if (blocks.contains(runAddr)) {
+            i++;
+            continue;
+        }
+        int runLength = 1;
+        while (i + runLength < count) {
+            const uint64_t addr = runAddr + runLength * BLOCK_SIZE;
+            if (addr < runAddr || blocks.contains(addr)) {
+                break;
+            }
+            runLength++;
+        }
+
+        const QByteArray run = Core()->ioRead(runAddr, runLength * static_cast<int>(BLOCK_SIZE));
+        for (int j = 0; j < runLength; j++) {
+            insert(runAddr + j * BLOCK_SIZE, run.mid(j * static_cast<int>(BLOCK_SIZE), static_cast<int>(BLOCK_SIZE)));
+        }
+        i += runLength;
+    }
+}
+
+void MemoryBlockCache::insert(uint64_t blockAddr, const QByteArray &data)
+{
+    lru.push_front(blockAddr);
+    blocks.insert(blockAddr, { data, lru.begin() });
+}
+
+void MemoryBlockCache::evict(int capacity)
+{
+    while (blocks.size() > capacity && !lru.empty()) {
+        blocks.remove(lru.back());
+        lru.pop_back();
+    }
+}
 
 static constexpr uint64_t MAX_COPY_SIZE = 128 * 1024 * 1024;
 static constexpr int MAX_LINE_WIDTH_PRESET = 32;
 static constexpr int MAX_LINE_WIDTH_BYTES = 128 * 1024;
+/** Number of refreshes during which a changed byte stays highlighted */
+static constexpr int CHANGE_HISTORY = 4;
+static constexpr quint8 NO_CHANGE = 0xff;
+
+/**
+ * @brief Set bit i of \a bits (zero initialized, one bit per byte) when a[i] != b[i]
+ */
+static void diffBitmap(const uchar *a, const uchar *b, int length, quint64 *bits)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 64 <= length; i += 64) {
+        const __m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                             _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        const __m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 32)),
+                                             _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 32)));
+        const quint64 equal = static_cast<quint32>(_mm256_movemask_epi8(lo))
+                | static_cast<quint64>(static_cast<quint32>(_mm256_movemask_epi8(hi))) << 32;
+        bits[i / 64] = ~equal;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (; i + 64 <= length; i += 64) {
+        quint64 equal = 0;
+        for (int j = 0; j < 4; j++) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 16 * j));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 16 * j));
+            equal |= static_cast<quint64>(static_cast<quint16>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)))) << (16 * j);
+        }
+        bits[i / 64] = ~equal;
+    }
+#endif
+    // Remainder, or everything without SIMD: skip equal words
+    for (; i < length; i += 8) {
+        quint64 x = 0;
+        quint64 y = 0;
+        const int n = std::min(8, length - i);
+        memcpy(&x, a + i, n);
+        memcpy(&y, b + i, n);
+        if (x == y) {
+            continue;
+        }
+        for (int j = i; j < i + n; j++) {
+            if (a[j] != b[j]) {
+                bits[j / 64] |= 1ull << (j % 64);
+            }
+        }
+    }
+}
 
 HexWidget::HexWidget(QWidget *parent) :
     QScrollArea(parent),
@@ -41,7 +195,8 @@ HexWidget::HexWidget(QWidget *parent) :
     showHeader(true),
     showAscii(true),
     showExHex(true),
-    showExAddr(true)
+    showExAddr(true),
+    useGlyphAtlas(Config()->getHexdumpGlyphAtlas())
 {
     setMouseTracking(true);
     setFocusPolicy(Qt::FocusPolicy::StrongFocus);
@@ -50,6 +205,17 @@ HexWidget::HexWidget(QWidget *parent) :
     connect(Config(), &Configuration::colorsUpdated, this, &HexWidget::updateColors);
     connect(Config(), &Configuration::fontsUpdated, this, [this]() { setMonospaceFont(
         Config()->getFont()); });
+    auto refreshAddressMeta = [this]() {
+        fetchAddressMeta();
+        viewport()->update();
+    };
+    connect(Core(), &IaitoCore::flagsChanged, this, refreshAddressMeta);
+    connect(Core(), &IaitoCore::commentsChanged, this, refreshAddressMeta);
+    // Connected before HexdumpWidget refreshes on the same signals
+    auto markDataStepped = [this]() { dataStepped = true; };
+    connect(Core(), &IaitoCore::registersChanged, this, markDataStepped);
+    connect(Core(), &IaitoCore::stackChanged, this, markDataStepped);
+    connect(Core(), &IaitoCore::instructionChanged, this, markDataStepped);
 
     auto sizeActionGroup = new QActionGroup(this);
     for (int i = 1; i <= 8; i *= 2) {
@@ -169,8 +335,9 @@ HexWidget::HexWidget(QWidget *parent) :
 
     startAddress = 0ULL;
     cursor.address = 0ULL;
-    data.reset(new MemoryData());
-    oldData.reset(new MemoryData());
+    blockCache = std::make_shared<MemoryBlockCache>(Config()->getHexdumpBlockCacheSize());
+    data.reset(new MemoryData(blockCache));
+    oldData.reset(new MemoryData(blockCache));
 
     fetchData();
     updateCursorMeta();
@@ -254,22 +421,34 @@ void HexWidget::setItemGroupSize(int size)
 }
 
 /**
- * @brief Checks if Item at the address changed compared to the last read data.
- * @param address Address of Item to be compared.
- * @return True if Item is different, False if Item is equal or last read didn't contain the address.
- * @see HexWidget#readItem
- *
- * Checks if current Item at the address changed compared to the last read data.
- * It is assumed that the current read data buffer contains the address.
+ * @brief Steps since the bytes of an item last changed.
+ * @param address Address of the first byte of the item.
+ * @param length Length of the item in bytes.
+ * @return Smallest age of the bytes, NO_CHANGE if none of them changed in the last CHANGE_HISTORY steps.
+ * @see HexWidget#updateChangeAges
  */
-bool HexWidget::isItemDifferentAt(uint64_t address) {
-    char oldItem[sizeof(uint64_t)] = {};
-    char newItem[sizeof(uint64_t)] = {};
-    if (data->copy(newItem, address, static_cast<size_t>(itemByteLen)) &&
-        oldData->copy(oldItem, address, static_cast<size_t>(itemByteLen))) {
-        return memcmp(oldItem, newItem, sizeof(oldItem)) != 0;
+int HexWidget::changeAgeAt(uint64_t address, int length) const
+{
+    int age = NO_CHANGE;
+    if (address < changeAgesStart) {
+        return age;
+    }
+    const uint64_t offset = address - changeAgesStart;
+    for (uint64_t i = offset; i < offset + length && i < static_cast<uint64_t>(changeAges.size()); i++) {
+        age = std::min<int>(age, changeAges[static_cast<int>(i)]);
     }
-    return false;
+    return age;
+}
+
+/**
+ * @brief Color of an item that changed \a age steps ago, fading from diffColor to defColor.
+ */
+QColor HexWidget::changedItemColor(int age) const
+{
+    const qreal t = static_cast<qreal>(age) / CHANGE_HISTORY;
+    return QColor::fromRgbF(diffColor.redF() * (1 - t) + defColor.redF() * t,
+                            diffColor.greenF() * (1 - t) + defColor.greenF() * t,
+                            diffColor.blueF() * (1 - t) + defColor.blueF() * t);
 }
 
 void HexWidget::updateCounts()
@@ -402,6 +581,7 @@ void HexWidget::updateColors()
     defColor = Config()->getColor("btext");
     addrColor = Config()->getColor("func_var_addr");
     diffColor = Config()->getColor("graph.diff.unmatch");
+    glyphAtlas.clear();
 
     updateCursorMeta();
     viewport()->update();
@@ -1004,6 +1184,20 @@ void HexWidget::drawAddrArea(QPainter &painter)
     painter.drawLine(QLineF(vLineOffset, 0, vLineOffset, viewport()->height()));
 }
 
+bool HexWidget::canUseGlyphAtlas() const
+{
+    return useGlyphAtlas && itemFormat == ItemFormatHex && itemPrefixLen == 0;
+}
+
+void HexWidget::drawGlyphFragments(QPainter &painter,
+                                   const QHash<QRgb, QVector<QPainter::PixmapFragment>> &fragments)
+{
+    for (auto it = fragments.constBegin(); it != fragments.constEnd(); ++it) {
+        painter.drawPixmapFragments(it.value().constData(), it.value().size(),
+                                    glyphAtlas.pixmap(QColor::fromRgba(it.key())));
+    }
+}
+
 void HexWidget::drawItemArea(QPainter &painter)
 {
     QRectF itemRect(itemArea.topLeft(), QSizeF(itemWidth(), lineHeight));
@@ -1012,32 +1206,62 @@ void HexWidget::drawItemArea(QPainter &painter)
 
     fillSelectionBackground(painter);
 
+    const bool useAtlas = canUseGlyphAtlas();
+    if (useAtlas) {
+        glyphAtlas.setup(monospaceFont, charWidth, lineHeight, devicePixelRatio(viewport()));
+    }
+    /* Fragments are grouped by color, one draw call each */
+    QHash<QRgb, QVector<QPainter::PixmapFragment>> fragments;
+    quint8 bytes[sizeof(uint64_t)];
+
+    QVector<QRectF> markers;
+    auto meta = addressMeta.constBegin();
+
     uint64_t itemAddr = startAddress;
     for (int line = 0; line < visibleLines; ++line) {
         itemRect.moveLeft(itemArea.left());
         for (int j = 0; j < itemColumns; ++j) {
             for (int k = 0; k < itemGroupSize && itemAddr <= data->maxIndex(); ++k, itemAddr += itemByteLen) {
-                itemString = renderItem(itemAddr - startAddress, &itemColor);
-
-                if (!getFlagsAndComment(itemAddr).isEmpty()) {
-                    QColor markerColor(borderColor);
-                    markerColor.setAlphaF(0.5);
-                    const auto shape = rangePolygons(itemAddr, itemAddr, false)[0];
-                    painter.setPen(markerColor);
-                    painter.drawPolyline(shape);
+                while (meta != addressMeta.constEnd() && meta->offset < itemAddr) {
+                    ++meta;
+                }
+                if (meta != addressMeta.constEnd() && meta->offset == itemAddr) {
+                    markers.append(itemRectangle(static_cast<int>(itemAddr - startAddress)));
+                }
+
+                const bool fromAtlas = useAtlas && data->copy(bytes, itemAddr, static_cast<size_t>(itemByteLen));
+                if (fromAtlas) {
+                    itemColor = itemByteLen == 1 ? this->itemColor(bytes[0]) : defColor;
+                } else {
+                    itemString = renderItem(itemAddr - startAddress, &itemColor);
                 }
                 if (selection.contains(itemAddr)  && !cursorOnAscii) {
                     itemColor = palette().highlightedText().color();
                 }
-                if (isItemDifferentAt(itemAddr)) {
-                    itemColor.setRgb(diffColor.rgb());
+                const int changeAge = changeAgeAt(itemAddr, itemByteLen);
+                if (changeAge != NO_CHANGE) {
+                    itemColor = changedItemColor(changeAge);
+                }
+
+                QChar firstChar;
+                if (fromAtlas) {
+                    auto &colorFragments = fragments[itemColor.rgba()];
+                    QPointF pos = itemRect.topLeft();
+                    for (int i = 0; i < itemByteLen; i++, pos.rx() += 2 * charWidth) {
+                        /* Most significant byte first */
+                        colorFragments.append(glyphAtlas.hexPair(bytes[itemBigEndian ? i : itemByteLen - 1 - i], pos));
+                    }
+                    const quint8 first = bytes[itemBigEndian ? 0 : itemByteLen - 1];
+                    firstChar = QLatin1Char("0123456789abcdef"[first >> 4]);
+                } else {
+                    painter.setPen(itemColor);
+                    painter.drawText(itemRect, Qt::AlignVCenter, itemString);
+                    firstChar = itemString.at(0);
                 }
-                painter.setPen(itemColor);
-                painter.drawText(itemRect, Qt::AlignVCenter, itemString);
                 itemRect.translate(itemWidth(), 0);
                 if (cursor.address == itemAddr) {
                     auto &itemCursor = cursorOnAscii ? shadowCursor : cursor;
-                    itemCursor.cachedChar = itemString.at(0);
+                    itemCursor.cachedChar = firstChar;
                     itemCursor.cachedColor = itemColor;
                 }
             }
@@ -1046,6 +1270,16 @@ void HexWidget::drawItemArea(QPainter &painter)
         itemRect.translate(0, lineHeight);
     }
 
+    drawGlyphFragments(painter, fragments);
+
+    if (!markers.isEmpty()) {
+        QColor markerColor(borderColor);
+        markerColor.setAlphaF(0.5);
+        painter.setPen(markerColor);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRects(markers);
+    }
+
     painter.setPen(borderColor);
 
     qreal vLineOffset = asciiArea.left() - charWidth;
@@ -1058,6 +1292,12 @@ void HexWidget::drawAsciiArea(QPainter &painter)
 
     fillSelectionBackground(painter, true);
 
+    const bool useAtlas = useGlyphAtlas;
+    if (useAtlas) {
+        glyphAtlas.setup(monospaceFont, charWidth, lineHeight, devicePixelRatio(viewport()));
+    }
+    QHash<QRgb, QVector<QPainter::PixmapFragment>> fragments;
+
     uint64_t address = startAddress;
     QChar ascii;
     QColor color;
@@ -1068,10 +1308,10 @@ void HexWidget::drawAsciiArea(QPainter &painter)
             if (selection.contains(address) && cursorOnAscii) {
                 color = palette().highlightedText().color();
             }
-            if (isItemDifferentAt(address)) {
-                color.setRgb(diffColor.rgb());
+            const int changeAge = changeAgeAt(address, 1);
+            if (changeAge != NO_CHANGE) {
+                color = changedItemColor(changeAge);
             }
-            painter.setPen(color);
             /* Dots look ugly. Use fillRect() instead of drawText(). */
             if (ascii == '.') {
                 qreal a = cursor.screenPos.width();
@@ -1079,7 +1319,11 @@ void HexWidget::drawAsciiArea(QPainter &painter)
                 p.rx() += (charWidth - a) / 2 + 1;
                 p.ry() += - 2 * a;
                 painter.fillRect(QRectF(p, QSizeF(a, a)), color);
+            } else if (useAtlas) {
+                fragments[color.rgba()].append(glyphAtlas.ascii(static_cast<uint8_t>(ascii.unicode()),
+                                                                 charRect.topLeft()));
             } else {
+                painter.setPen(color);
                 painter.drawText(charRect, Qt::AlignVCenter, ascii);
             }
             charRect.translate(charWidth, 0);
@@ -1090,6 +1334,8 @@ void HexWidget::drawAsciiArea(QPainter &painter)
             }
         }
     }
+
+    drawGlyphFragments(painter, fragments);
 }
 
 void HexWidget::fillSelectionBackground(QPainter &painter, bool ascii)
@@ -1479,10 +1725,16 @@ QChar HexWidget::renderAscii(int offset, QColor *color)
  */
 QString HexWidget::getFlagsAndComment(uint64_t address)
 {
-    QString flagNames = Core()->listFlagsAsStringAt(address);
+    AddressMetaDescription key = { address, QString(), QString() };
+    auto it = std::lower_bound(addressMeta.constBegin(), addressMeta.constEnd(), key);
+    if (it == addressMeta.constEnd() || it->offset != address) {
+        return QString();
+    }
+
+    const QString &flagNames = it->flags;
     QString metaData = flagNames.isEmpty() ? "" : "Flags: " + flagNames.trimmed();
 
-    QString comment = Core()->getCommentAt(address);
+    const QString &comment = it->comment;
     if (!comment.isEmpty()) {
         if (!metaData.isEmpty()) {
             metaData.append("\n");
@@ -1495,8 +1747,80 @@ QString HexWidget::getFlagsAndComment(uint64_t address)
 
 void HexWidget::fetchData()
 {
+    CommandProfiler::Context profilerContext(QStringLiteral("HexWidget"));
+
     data.swap(oldData);
     data->fetch(startAddress, bytesPerScreen());
+    updateChangeAges();
+    fetchAddressMeta();
+}
+
+void HexWidget::updateChangeAges()
+{
+    int length = 0;
+    if (data->maxIndex() >= startAddress) {
+        const uint64_t available = data->maxIndex() - startAddress;
+        length = available < static_cast<uint64_t>(bytesPerScreen()) ? static_cast<int>(available + 1) : bytesPerScreen();
+    }
+
+    // The bytes only get older on a debug step or a write, not when scrolling or
+    // when unrelated commands refresh the view
+    const bool stepped = dataStepped;
+    dataStepped = false;
+
+    QVector<quint8> ages(length, NO_CHANGE);
+    if (!length) {
+        changeAges = ages;
+        return;
+    }
+    const uint64_t newLast = startAddress + (length - 1);
+    if (!changeAges.isEmpty()) {
+        const uint64_t oldLast = changeAgesStart + (changeAges.size() - 1);
+        const uint64_t last = std::min(oldLast, newLast);
+        for (uint64_t addr = std::max(changeAgesStart, startAddress); addr <= last; addr++) {
+            int age = changeAges[static_cast<int>(addr - changeAgesStart)];
+            if (age != NO_CHANGE && stepped) {
+                age = age + 1 < CHANGE_HISTORY ? age + 1 : NO_CHANGE;
+            }
+            ages[static_cast<int>(addr - startAddress)] = static_cast<quint8>(age);
+            if (addr == last) {
+                break;
+            }
+        }
+    }
+
+    // Compare the part of the screen that was also fetched last time
+    const uint64_t diffStart = std::max<uint64_t>(startAddress, oldData->minIndex());
+    const uint64_t diffLast = std::min<uint64_t>(newLast, oldData->maxIndex());
+    if (diffStart <= diffLast) {
+        const int diffLength = static_cast<int>(diffLast - diffStart + 1);
+        QByteArray oldBytes(diffLength, Qt::Uninitialized);
+        QByteArray newBytes(diffLength, Qt::Uninitialized);
+        if (oldData->copy(oldBytes.data(), diffStart, diffLength)
+                && data->copy(newBytes.data(), diffStart, diffLength)) {
+            QVector<quint64> bits((diffLength + 63) / 64, 0);
+            diffBitmap(reinterpret_cast<const uchar *>(oldBytes.constData()),
+                       reinterpret_cast<const uchar *>(newBytes.constData()), diffLength, bits.data());
+            const int base = static_cast<int>(diffStart - startAddress);
+            for (int w = 0; w < bits.size(); w++) {
+                for (quint64 word = bits[w]; word; word &= word - 1) {
+                    ages[base + w * 64 + qCountTrailingZeroBits(word)] = 0;
+                }
+            }
+        }
+    }
+
+    changeAges = ages;
+    changeAgesStart = startAddress;
+}
+
+void HexWidget::fetchAddressMeta()
+{
+    RVA end = startAddress + bytesPerScreen();
+    if (end < startAddress) {
+        end = UT64_MAX;
+    }
+    addressMeta = Core()->getAddressMetaInRange(startAddress, end);
 }
 
 BasicCursor HexWidget::screenPosToAddr(const QPoint &point,  bool middle) const
@@ -4,11 +4,16 @@
 #include "Iaito.h"
 #include "dialogs/HexdumpRangeDialog.h"
 #include "common/IOModesController.h"
+#include "HexGlyphAtlas.h"
 
 #include <QScrollArea>
 #include <QTimer>
 #include <QMenu>
+#include <QHash>
+#include <QPainter>
+#include <QPixmap>
 #include <memory>
+#include <list>
 
 struct BasicCursor
 {
@@ -118,17 +123,59 @@ private:
     QByteArray m_buffer;
 };
 
+/**
+ * @brief LRU cache of aligned memory blocks, shared by the current and the previous
+ * MemoryData of a HexWidget.
+ *
+ * Missing blocks are read with as few IaitoCore::ioRead() calls as possible, and the
+ * screen in the scroll direction is prefetched. Everything is dropped when the analysis
+ * generation changes, i.e. after writes, IO map changes or debugger steps.
+ */
+class MemoryBlockCache
+{
+public:
+    static constexpr uint64_t BLOCK_SIZE = 4096;
+
+    explicit MemoryBlockCache(int capacity);
+
+    /**
+     * @param capacity - maximum number of cached blocks
+     */
+    void setCapacity(int capacity);
+
+    /**
+     * @brief Get \a count consecutive blocks starting at the aligned address \a firstBlockAddr
+     */
+    QVector<QByteArray> fetch(uint64_t firstBlockAddr, int count);
+
+private:
+    struct Entry {
+        QByteArray data;
+        std::list<uint64_t>::iterator lruPos;
+    };
+
+    void load(uint64_t firstBlockAddr, int count);
+    void insert(uint64_t blockAddr, const QByteArray &data);
+    void evict(int capacity);
+
+    int capacity;
+    quint64 generation = 0;
+    uint64_t lastFirstBlockAddr = 0;
+    QHash<uint64_t, Entry> blocks;
+    /** Most recently used first */
+    std::list<uint64_t> lru;
+};
+
 class MemoryData : public AbstractData
 {
 public:
-    MemoryData() {}
+    explicit MemoryData(std::shared_ptr<MemoryBlockCache> cache) : m_cache(std::move(cache)) {}
     ~MemoryData() override {}
-    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t BLOCK_SIZE = MemoryBlockCache::BLOCK_SIZE;
 
     void fetch(uint64_t address, int length) override
     {
-        // FIXME: reuse data if possible
-        const uint64_t blockSize = 0x1000ULL;
+        const uint64_t blockSize = BLOCK_SIZE;
         uint64_t alignedAddr = address & ~(blockSize - 1);
         int offset = address - alignedAddr;
         int len = (offset + length + (blockSize - 1)) & ~(blockSize - 1);
@@ -138,11 +185,9 @@ public:
             m_lastValidAddr = -1;
             len = m_lastValidAddr - m_firstBlockAddr + 1;
         }
-        m_blocks.clear();
-        uint64_t addr = alignedAddr;
-        for (ut64 i = 0; i < len / blockSize; ++i, addr += blockSize) {
-            m_blocks.append(Core()->ioRead(addr, blockSize));
-        }
+        // The blocks are implicitly shared with the cache, they stay valid for the
+        // diff against the next fetch even if the cache drops them meanwhile
+        m_blocks = m_cache->fetch(alignedAddr, static_cast<int>(len / blockSize));
     }
 
     bool copy(void *out, uint64_t addr, size_t len) override {
@@ -175,6 +220,7 @@ public:
     }
 
 private:
+    std::shared_ptr<MemoryBlockCache> m_cache;
     QVector<QByteArray> m_blocks;
     uint64_t m_firstBlockAddr = 0;
     uint64_t m_lastValidAddr = 0;
@@ -332,6 +378,11 @@ private:
     void drawItemArea(QPainter &painter);
     void drawAsciiArea(QPainter &painter);
     void fillSelectionBackground(QPainter &painter, bool ascii = false);
+    /**
+     * @brief Items can be drawn from glyphAtlas, only plain hex is pre-rendered
+     */
+    bool canUseGlyphAtlas() const;
+    void drawGlyphFragments(QPainter &painter, const QHash<QRgb, QVector<QPainter::PixmapFragment>> &fragments);
     void updateMetrics();
     void updateAreasPosition();
     void updateAreasHeight();
@@ -339,12 +390,21 @@ private:
     void setCursorAddr(BasicCursor addr, bool select = false);
     void updateCursorMeta();
     void setCursorOnAscii(bool ascii);
-    bool isItemDifferentAt(uint64_t address);
+    int changeAgeAt(uint64_t address, int length) const;
+    QColor changedItemColor(int age) const;
+    /**
+     * @brief Diff the bytes on screen against the previous fetch and age the older changes
+     */
+    void updateChangeAges();
     const QColor itemColor(uint8_t byte);
     QVariant readItem(int offset, QColor *color = nullptr);
     QString renderItem(int offset, QColor *color = nullptr);
     QChar renderAscii(int offset, QColor *color = nullptr);
     QString getFlagsAndComment(uint64_t address);
+    /**
+     * @brief Refresh addressMeta for the bytes on screen
+     */
+    void fetchAddressMeta();
     /**
      * @brief Get the location on which operations such as Writing should apply.
      * @return Start of selection if multiple bytes are selected. Otherwise, the curren seek of the widget.
@@ -490,6 +550,7 @@ private:
     bool showAscii;
     bool showExHex;
     bool showExAddr;
+    bool useGlyphAtlas;
 
     QColor borderColor;
     QColor backgroundColor;
@@ -521,8 +582,17 @@ private:
     QList<QAction *> actionsWriteString;
     QList<QAction *> actionsWriteOther;
 
+    std::shared_ptr<MemoryBlockCache> blockCache;
     std::unique_ptr<AbstractData> oldData;
     std::unique_ptr<AbstractData> data;
+    /** Refreshes since each byte on screen changed, starting at changeAgesStart */
+    QVector<quint8> changeAges;
+    uint64_t changeAgesStart = 0;
+    /** Whether the target stepped or memory was written since the last fetch, ages only advance then */
+    bool dataStepped = false;
+    /** Flags and comments on screen, so painting does not need the core lock */
+    QVector<AddressMetaDescription> addressMeta;
+    HexGlyphAtlas glyphAtlas;
     IOModesController ioModesController;
 
 };
@@ -5,6 +5,7 @@
 #include "common/Configuration.h"
 #include "common/TempConfig.h"
 #include "common/SyntaxHighlighter.h"
+#include "common/CommandProfiler.h"
 #include "core/MainWindow.h"
 
 #include <QJsonObject>
@@ -118,7 +119,10 @@ void HexdumpWidget::onSeekChanged(RVA addr)
     refresh(addr);
 }
 
-HexdumpWidget::~HexdumpWidget() {}
+HexdumpWidget::~HexdumpWidget()
+{
+    cancelHashTask();
+}
 
 QString HexdumpWidget::getWidgetType()
 {
@@ -135,6 +139,9 @@ void HexdumpWidget::refresh(RVA addr)
     if (!refreshDeferrer->attemptRefresh(addr == RVA_INVALID ? nullptr : new RVA(addr))) {
         return;
     }
+
+    CommandProfiler::Context profilerContext(objectName());
+
     sent_seek = true;
     if (addr != RVA_INVALID) {
         ui->hexTextView->seek(addr);
@@ -205,12 +212,9 @@ void HexdumpWidget::fontsUpdated()
 
 void HexdumpWidget::clearParseWindow()
 {
+    cancelHashTask();
     ui->hexDisasTextEdit->setPlainText("");
-    ui->bytesEntropy->setText("");
-    ui->bytesMD5->setText("");
-    ui->bytesSHA1->setText("");
-    ui->bytesSHA256->setText("");
-    ui->bytesCRC32->setText("");
+    setHashes(QStringList());
 }
 
 void HexdumpWidget::showSidePanel(bool show)
@@ -254,16 +258,75 @@ void HexdumpWidget::updateParseWindow(RVA start_address, int size)
                                                                     .arg(size)
                                                                     , start_address) : "");
     } else {
-        // Fill the information tab hashes and entropy
-        ui->bytesMD5->setText(Core()->cmdRawAt(QString("ph md5 %1").arg(size), start_address).trimmed());
-        ui->bytesSHA1->setText(Core()->cmdRawAt(QString("ph sha1 %1").arg(size), start_address).trimmed());
-        ui->bytesSHA256->setText(Core()->cmdRawAt(QString("ph sha256 %1").arg(size), start_address).trimmed());
-        ui->bytesCRC32->setText(Core()->cmdRawAt(QString("ph crc32 %1").arg(size), start_address).trimmed());
-        ui->bytesEntropy->setText(Core()->cmdRawAt(QString("ph entropy %1").arg(size), start_address).trimmed());
-        ui->bytesMD5->setCursorPosition(0);
-        ui->bytesSHA1->setCursorPosition(0);
-        ui->bytesSHA256->setCursorPosition(0);
-        ui->bytesCRC32->setCursorPosition(0);
+        updateHashes(start_address, size);
+    }
+}
+
+void HexdumpWidget::updateHashes(RVA start_address, int size)
+{
+    const quint64 generation = Core()->getAnalysisGeneration();
+    for (int i = 0; i < hashCache.size(); i++) {
+        const HashCacheEntry &entry = hashCache[i];
+        if (entry.address == start_address && entry.size == size && entry.generation == generation) {
+            cancelHashTask();
+            hashCache.move(i, 0);
+            setHashes(hashCache.first().hashes);
+            return;
+        }
+    }
+
+    if (hashTask && hashTask->getAddress() == start_address && hashTask->getSize() == size
+            && hashTask->getGeneration() == generation) {
+        // Already working on it
+        return;
+    }
+    cancelHashTask();
+    setHashes(QStringList());
+
+    hashTask = QSharedPointer<HashTask>(new HashTask(start_address, size));
+    HashTask *task = hashTask.data();
+    connect(task, &HashTask::progressChanged, this, [this, task](int percent) {
+        if (hashTask.data() != task) {
+            return;
+        }
+        const QString progress = tr("Calculating... %1%").arg(percent);
+        for (QLineEdit *edit : { ui->bytesMD5, ui->bytesSHA1, ui->bytesSHA256, ui->bytesCRC32,
+                                 ui->bytesEntropy }) {
+            edit->setPlaceholderText(progress);
+        }
+    });
+    connect(task, &HashTask::hashFinished, this, [this, task](const QStringList &hashes) {
+        if (hashTask.data() != task) {
+            return;
+        }
+        const int maxCachedHashes = 16;
+        hashCache.prepend({ task->getAddress(), task->getSize(), task->getGeneration(), hashes });
+        while (hashCache.size() > maxCachedHashes) {
+            hashCache.removeLast();
+        }
+        hashTask.reset();
+        setHashes(hashes);
+    });
+    Core()->getAsyncTaskManager()->start(hashTask);
+}
+
+void HexdumpWidget::cancelHashTask()
+{
+    if (hashTask) {
+        // Not waited for, its results are dropped once hashTask points elsewhere
+        hashTask->interrupt();
+        hashTask.reset();
+    }
+}
+
+void HexdumpWidget::setHashes(const QStringList &hashes)
+{
+    const QString placeholder = tr("Select bytes to display information");
+    QLineEdit *edits[] = { ui->bytesMD5, ui->bytesSHA1, ui->bytesSHA256, ui->bytesCRC32, ui->bytesEntropy };
+    for (int i = 0; i < HashTask::ResultCount; i++) {
+        edits[i]->setPlaceholderText(placeholder);
+        edits[i]->setText(hashes.value(i));
+        edits[i]->setCursorPosition(0);
     }
 }
 
@@ -15,6 +15,7 @@
 #include "common/Highlighter.h"
 #include "common/SvgIconEngine.h"
 #include "HexWidget.h"
+#include "common/HashTask.h"
 
 #include "Dashboard.h"
 
@@ -47,6 +48,16 @@ private:
     bool sent_seek = false;
 
     RefreshDeferrer *refreshDeferrer;
+
+    struct HashCacheEntry {
+        RVA address;
+        int size;
+        quint64 generation;
+        QStringList hashes;
+    };
+    /** Most recent first */
+    QList<HashCacheEntry> hashCache;
+    QSharedPointer<HashTask> hashTask;
     QSyntaxHighlighter *syntaxHighLighter;
 
     void refresh();
@@ -57,6 +68,12 @@ private:
 
     void refreshSelectionInfo();
     void updateParseWindow(RVA start_address, int size);
+    /**
+     * @brief Fill the information tab, from hashCache or by starting a HashTask
+     */
+    void updateHashes(RVA start_address, int size);
+    void setHashes(const QStringList &hashes);
+    void cancelHashTask();
     void clearParseWindow();
     void showSidePanel(bool show);
 
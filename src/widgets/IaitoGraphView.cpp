@@ -238,6 +238,13 @@ void IaitoGraphView::refreshView()
 {
     initFont();
     setLayoutConfig(getLayoutConfig());
+    setCacheDirty();
+}
+
+qreal IaitoGraphView::minimumDetailScale() const
+{
+    // Same threshold below which drawBlock() stops rendering text
+    return 4.0 / charWidth;
 }
 
 bool IaitoGraphView::gestureEvent(QGestureEvent *event)
@@ -104,6 +104,8 @@ protected:
      */
     virtual void restoreCurrentBlock();
 
+    qreal minimumDetailScale() const override;
+
     void initFont();
     QPoint getTextOffset(int line) const;
     GraphLayout::LayoutConfig getLayoutConfig();
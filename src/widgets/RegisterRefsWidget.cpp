@@ -189,14 +189,14 @@ void RegisterRefsWidget::refreshRegisterRef()
 
     registerRefModel->beginResetModel();
 
-    QList<QJsonObject> regRefs = Core()->getRegisterRefs();
+    const QVector<RegisterRefChain> regRefs = Core()->getRegisterRefs();
     registerRefs.clear();
-    for (const QJsonObject &reg : regRefs) {
+    for (const RegisterRefChain &reg : regRefs) {
         RegisterRefDescription desc;
 
-        desc.value = RAddressString(reg["value"].toVariant().toULongLong());
-        desc.reg = reg["name"].toVariant().toString();
-        desc.refDesc = Core()->formatRefDesc(reg["ref"].toObject());
+        desc.value = RAddressString(reg.value);
+        desc.reg = reg.name;
+        desc.refDesc = Core()->formatRefDesc(reg.refs);
 
         registerRefs.push_back(desc);
     }
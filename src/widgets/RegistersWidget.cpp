@@ -7,6 +7,7 @@
 #include <QCollator>
 #include <QLabel>
 #include <QLineEdit>
+#include "common/CommandProfiler.h"
 
 RegistersWidget::RegistersWidget(MainWindow *main) :
     IaitoDockWidget(main),
@@ -41,6 +42,9 @@ void RegistersWidget::updateContents()
     if (!refreshDeferrer->attemptRefresh(nullptr)) {
         return;
     }
+
+    CommandProfiler::Context profilerContext(objectName());
+
     setRegisterGrid();
 }
 
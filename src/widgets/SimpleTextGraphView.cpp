@@ -251,7 +251,10 @@ void SimpleTextGraphView::restoreCurrentBlock()
 
 void SimpleTextGraphView::paintEvent(QPaintEvent *event)
 {
-    // SimpleTextGraphView is always dirty
-    setCacheDirty();
+    // The selected block is drawn into the cached tiles
+    if (selectedBlock != paintedSelectedBlock) {
+        paintedSelectedBlock = selectedBlock;
+        setCacheDirty();
+    }
     GraphView::paintEvent(event);
 }
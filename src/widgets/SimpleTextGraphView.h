@@ -76,6 +76,7 @@ protected:
 
     static const ut64 NO_BLOCK_SELECTED = RVA_INVALID;
     ut64 selectedBlock = NO_BLOCK_SELECTED;
+    ut64 paintedSelectedBlock = NO_BLOCK_SELECTED;
     bool enableBlockSelection = true;
     bool haveAddresses = false;
 private:
@@ -7,6 +7,7 @@
 #include "core/MainWindow.h"
 #include "QHeaderView"
 #include "QMenu"
+#include "common/CommandProfiler.h"
 
 StackWidget::StackWidget(MainWindow *main) :
     IaitoDockWidget(main),
@@ -64,6 +65,8 @@ void StackWidget::updateContents()
         return;
     }
 
+    CommandProfiler::Context profilerContext(objectName());
+
     setStackGrid();
 }
 
@@ -148,16 +151,19 @@ StackModel::StackModel(QObject *parent)
 
 void StackModel::reload()
 {
-    QList<QJsonObject> stackItems = Core()->getStack();
+    const QVector<AddrRefChain> stackItems = Core()->getStack();
 
     beginResetModel();
     values.clear();
-    for (const QJsonObject &stackItem : stackItems) {
+    for (const AddrRefChain &stackItem : stackItems) {
+        if (stackItem.isEmpty()) {
+            continue;
+        }
         Item item;
 
-        item.offset = stackItem["addr"].toVariant().toULongLong();
-        item.value = RAddressString(stackItem["value"].toVariant().toULongLong());
-        item.refDesc = Core()->formatRefDesc(stackItem["ref"].toObject());
+        item.offset = stackItem.first().addr;
+        item.value = RAddressString(stackItem.first().value);
+        item.refDesc = Core()->formatRefDesc(stackItem, 1);
 
         values.push_back(item);
     }
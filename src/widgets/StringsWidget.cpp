@@ -223,11 +223,9 @@ StringsWidget::~StringsWidget() {}
 
 void StringsWidget::refreshStrings()
 {
-    if (task) {
-        task->wait();
-    }
-
+    // A pending search is dropped and a running one discards its result
     task = QSharedPointer<StringsTask>(new StringsTask());
+    task->setCoalescingKey(QString("strings-%1").arg(reinterpret_cast<quintptr>(this)));
     connect(task.data(), &StringsTask::stringSearchFinished, this,
             &StringsWidget::stringSearchFinished);
     Core()->getAsyncTaskManager()->start(task);